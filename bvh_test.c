@@ -0,0 +1,272 @@
+#include <stdio.h> // Для вывода результатов
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+/*******************************************************************************************
+*
+*   bvh_test - проверка BVH полным перебором и замер пропускной способности
+*
+*   Строит BVH по случайному набору прямоугольников и сравнивает каждый запрос
+*   (прямоугольник, луч, отрезок, свип) с полным перебором: те же индексы, тот же t и
+*   нормаль. Запросы прямоугольником дополнительно проверяются с малым maxIndices -
+*   должны остаться наименьшие индексы. Затем печатает запросы/сек для BVH и перебора.
+*
+*   Запуск: bvh_test [--count 2000] [--queries 20000] [--seed 1]
+*   Код возврата: 0 - все проверки прошли, 1 - есть расхождения
+*
+********************************************************************************************/
+
+#include "raylib.h" // Rectangle, Vector2
+#define PLATFORM_BVH_IMPLEMENTATION
+#include "platform_bvh.h" // Проверяемое дерево
+#define RNG_STREAM_IMPLEMENTATION
+#include "rng_stream.h" // Воспроизводимые случайные данные
+#include "tool_timer.h" // NowSeconds
+
+#define TEST_WORLD_SIZE 10000.0f   // Сторона квадрата, в котором лежат прямоугольники
+#define TEST_TRUNCATED_MAX 3       // maxIndices для проверки усечения
+#define TEST_TYPE_COUNT 3          // Типы 0..2, как PlatformType
+
+typedef enum { QUERY_AABB = 0, QUERY_RAY, QUERY_SEGMENT, QUERY_SWEEP, QUERY_KIND_COUNT } QueryKind;
+static const char *queryNames[QUERY_KIND_COUNT] = { "aabb", "ray", "segment", "sweep" };
+
+// --- Случайные данные ---
+typedef struct TestWorld {
+    Rectangle *rects;       // Прямоугольники
+    int *types;             // Тип каждого
+    int count;              // Количество
+    BvhAabb *boxes;         // Запросы прямоугольником
+    BvhRay *rays;           // Лучи
+    BvhSegment *segments;   // Отрезки
+    BvhSweep *sweeps;       // Свипы
+    unsigned int *masks;    // Маска типов для каждого запроса
+    int queryCount;         // Запросов каждого вида
+} TestWorld;
+
+static float RandomRange(RngStream *rng, float min, float max)
+{
+    return min + (max - min)*RngNextFloat(rng);
+}
+
+static TestWorld GenerateWorld(int count, int queryCount, uint64_t seed)
+{
+    TestWorld world = { 0 };
+    RngStream rng = CreateRngStream(seed, 0);
+    world.count = count;
+    world.queryCount = queryCount;
+    world.rects = (Rectangle *)malloc(count*sizeof(Rectangle));
+    world.types = (int *)malloc(count*sizeof(int));
+    for (int i = 0; i < count; i++) {
+        // Платформы: широкие и низкие, иногда стены; координаты целые, как в уровне
+        bool wall = RngNextInt(&rng, 0, 9) == 0;
+        float w = wall ? (float)RngNextInt(&rng, 10, 50) : (float)RngNextInt(&rng, 40, 400);
+        float h = wall ? (float)RngNextInt(&rng, 100, 800) : (float)RngNextInt(&rng, 8, 40);
+        world.rects[i] = (Rectangle){ (float)RngNextInt(&rng, 0, (int)TEST_WORLD_SIZE), (float)RngNextInt(&rng, 0, (int)TEST_WORLD_SIZE), w, h };
+        world.types[i] = RngNextInt(&rng, 0, TEST_TYPE_COUNT - 1);
+    }
+
+    world.boxes = (BvhAabb *)malloc(queryCount*sizeof(BvhAabb));
+    world.rays = (BvhRay *)malloc(queryCount*sizeof(BvhRay));
+    world.segments = (BvhSegment *)malloc(queryCount*sizeof(BvhSegment));
+    world.sweeps = (BvhSweep *)malloc(queryCount*sizeof(BvhSweep));
+    world.masks = (unsigned int *)malloc(queryCount*sizeof(unsigned int));
+    for (int q = 0; q < queryCount; q++) {
+        float x = RandomRange(&rng, 0.0f, TEST_WORLD_SIZE), y = RandomRange(&rng, 0.0f, TEST_WORLD_SIZE);
+        world.boxes[q] = (BvhAabb){ x, y, x + RandomRange(&rng, 1.0f, 600.0f), y + RandomRange(&rng, 1.0f, 600.0f) };
+
+        // Четверть лучей строго по осям - как лучи частиц и проверки под ногами
+        Vector2 dir = { RandomRange(&rng, -1.0f, 1.0f), RandomRange(&rng, -1.0f, 1.0f) };
+        if (q%4 == 0) dir = (q%8 == 0) ? (Vector2){ 0.0f, 1.0f } : (Vector2){ -1.0f, 0.0f };
+        world.rays[q] = (BvhRay){ { x, y }, dir, RandomRange(&rng, 100.0f, 3000.0f) };
+        world.segments[q] = (BvhSegment){ { x, y }, { x + RandomRange(&rng, -800.0f, 800.0f), y + RandomRange(&rng, -800.0f, 800.0f) } };
+        world.sweeps[q] = (BvhSweep){ { x, y, 40.0f, 40.0f }, { RandomRange(&rng, -500.0f, 500.0f), RandomRange(&rng, -500.0f, 500.0f) } };
+        if (q%16 == 0) world.sweeps[q].delta.x = 0.0f; // Падение строго вниз
+
+        int m = RngNextInt(&rng, 0, 3);
+        world.masks[q] = (m == 0) ? BVH_ALL_TYPES : (m == 1) ? BVH_TYPE_BIT(1) : (m == 2) ? BVH_TYPE_BIT(2) : (BVH_TYPE_BIT(1) | BVH_TYPE_BIT(2));
+    }
+    return world;
+}
+
+static void UnloadWorld(TestWorld world)
+{
+    free(world.rects); free(world.types);
+    free(world.boxes); free(world.rays); free(world.segments); free(world.sweeps); free(world.masks);
+}
+
+// --- Полный перебор ---
+static int BruteQueryAabb(const TestWorld *world, BvhAabb box, unsigned int mask, int *indices, int maxIndices)
+{
+    int found = 0;
+    for (int i = 0; i < world->count && found < maxIndices; i++) {
+        BvhAabb b = BvhAabbFromRec(world->rects[i]);
+        if ((BVH_TYPE_BIT(world->types[i]) & mask) && b.minX < box.maxX && b.maxX > box.minX && b.minY < box.maxY && b.maxY > box.minY)
+            indices[found++] = i;
+    }
+    return found;
+}
+
+// Ближайший вход луча в прямоугольники, расширенные на halfW/halfH (та же арифметика, что у слэбов BVH)
+static BvhHit BruteCast(const TestWorld *world, Vector2 o, Vector2 d, float maxT, float halfW, float halfH, unsigned int mask)
+{
+    BvhHit hit = { -1, maxT, { 0 }, { 0 } };
+    Vector2 inv = { (d.x != 0.0f) ? 1.0f/d.x : 0.0f, (d.y != 0.0f) ? 1.0f/d.y : 0.0f };
+    int hitAxis = -1;
+    for (int i = 0; i < world->count; i++) {
+        if (!(BVH_TYPE_BIT(world->types[i]) & mask)) continue;
+        BvhAabb b = BvhAabbFromRec(world->rects[i]);
+        float tMin = -INFINITY, tMax = INFINITY;
+        int axis = -1;
+        if (d.x == 0.0f) {
+            if (o.x < b.minX - halfW || o.x > b.maxX + halfW) continue;
+        } else {
+            float t1 = (b.minX - halfW - o.x)*inv.x, t2 = (b.maxX + halfW - o.x)*inv.x;
+            tMin = fminf(t1, t2); tMax = fmaxf(t1, t2); axis = 0;
+        }
+        if (d.y == 0.0f) {
+            if (o.y < b.minY - halfH || o.y > b.maxY + halfH) continue;
+        } else {
+            float t1 = (b.minY - halfH - o.y)*inv.y, t2 = (b.maxY + halfH - o.y)*inv.y;
+            if (fminf(t1, t2) > tMin) { tMin = fminf(t1, t2); axis = 1; }
+            tMax = fminf(tMax, fmaxf(t1, t2));
+        }
+        if (tMin > tMax || tMax < 0.0f || tMin < 0.0f || axis < 0) continue;
+        if (tMin < hit.t || (hit.index < 0 && tMin <= hit.t)) { hit.t = tMin; hit.index = i; hitAxis = axis; } // Перебор по возрастанию: при равном t остаётся меньший индекс
+    }
+    if (hit.index >= 0) {
+        hit.point = (Vector2){ o.x + d.x*hit.t, o.y + d.y*hit.t };
+        if (hitAxis == 0) hit.normal = (Vector2){ (d.x > 0.0f) ? -1.0f : 1.0f, 0.0f };
+        else hit.normal = (Vector2){ 0.0f, (d.y > 0.0f) ? -1.0f : 1.0f };
+    }
+    return hit;
+}
+
+static BvhHit BruteQuery(const TestWorld *world, QueryKind kind, int q)
+{
+    unsigned int mask = world->masks[q];
+    if (kind == QUERY_RAY) return BruteCast(world, world->rays[q].origin, world->rays[q].direction, world->rays[q].maxT, 0.0f, 0.0f, mask);
+    if (kind == QUERY_SEGMENT) {
+        const BvhSegment *s = &world->segments[q];
+        return BruteCast(world, s->start, (Vector2){ s->end.x - s->start.x, s->end.y - s->start.y }, 1.0f, 0.0f, 0.0f, mask);
+    }
+    const BvhSweep *s = &world->sweeps[q];
+    float halfW = s->box.width*0.5f, halfH = s->box.height*0.5f;
+    return BruteCast(world, (Vector2){ s->box.x + halfW, s->box.y + halfH }, s->delta, 1.0f, halfW, halfH, mask);
+}
+
+static void BvhQueryBatch(const PlatformBvh *bvh, const TestWorld *world, QueryKind kind, int first, int count, unsigned int mask, BvhHit *hits)
+{
+    if (kind == QUERY_RAY) RaycastPlatformBvhBatch(bvh, world->rays + first, count, mask, hits);
+    else if (kind == QUERY_SEGMENT) SegmentcastPlatformBvhBatch(bvh, world->segments + first, count, mask, hits);
+    else SweepPlatformBvhBatch(bvh, world->sweeps + first, count, mask, hits);
+}
+
+static bool SameHit(BvhHit a, BvhHit b)
+{
+    if (a.index != b.index) return false;
+    if (a.index < 0) return true;
+    return a.t == b.t && a.normal.x == b.normal.x && a.normal.y == b.normal.y;
+}
+
+// --- Проверка полным перебором: количество расхождений ---
+static int CheckWorld(const PlatformBvh *bvh, const TestWorld *world, int *mismatches)
+{
+    int total = 0;
+    int *expected = (int *)malloc(world->count*sizeof(int));
+    int *actual = (int *)malloc(world->count*sizeof(int));
+    for (int q = 0; q < world->queryCount; q++) {
+        // Полный результат и усечённый до TEST_TRUNCATED_MAX наименьших индексов
+        int limits[2] = { world->count, TEST_TRUNCATED_MAX };
+        for (int l = 0; l < 2; l++) {
+            int n1 = BruteQueryAabb(world, world->boxes[q], world->masks[q], expected, limits[l]);
+            int n2 = QueryPlatformBvhAabb(bvh, world->boxes[q], world->masks[q], actual, limits[l]);
+            if (n1 != n2 || memcmp(expected, actual, n1*sizeof(int)) != 0) mismatches[QUERY_AABB]++;
+        }
+    }
+
+    for (int kind = QUERY_RAY; kind < QUERY_KIND_COUNT; kind++) {
+        for (int q = 0; q < world->queryCount; q++) {
+            BvhHit hit;
+            BvhQueryBatch(bvh, world, kind, q, 1, world->masks[q], &hit);
+            BvhHit reference = BruteQuery(world, kind, q);
+            if (!SameHit(hit, reference)) {
+                if (mismatches[kind] == 0)
+                    printf("  %s mismatch at query %d: bvh index %d t %.6f, brute index %d t %.6f\n", queryNames[kind], q, hit.index, hit.t, reference.index, reference.t);
+                mismatches[kind]++;
+            }
+        }
+    }
+    for (int kind = 0; kind < QUERY_KIND_COUNT; kind++) total += mismatches[kind];
+    free(expected);
+    free(actual);
+    return total;
+}
+
+// --- Пропускная способность: запросы/сек для BVH (пакетом) и перебора ---
+static void Benchmark(const PlatformBvh *bvh, const TestWorld *world)
+{
+    int *indices = (int *)malloc(world->count*sizeof(int));
+    BvhHit *hits = (BvhHit *)malloc(world->queryCount*sizeof(BvhHit));
+    volatile long long sink = 0; // Чтобы результаты не выбросил оптимизатор
+
+    printf("\n%-8s %16s %16s %10s\n", "query", "bvh q/s", "brute q/s", "speedup");
+    for (int kind = 0; kind < QUERY_KIND_COUNT; kind++) {
+        double start = NowSeconds();
+        if (kind == QUERY_AABB) {
+            for (int q = 0; q < world->queryCount; q++) sink += QueryPlatformBvhAabb(bvh, world->boxes[q], BVH_ALL_TYPES, indices, world->count);
+        } else {
+            BvhQueryBatch(bvh, world, kind, 0, world->queryCount, BVH_ALL_TYPES, hits);
+            for (int q = 0; q < world->queryCount; q++) sink += hits[q].index;
+        }
+        double bvhSeconds = NowSeconds() - start;
+
+        start = NowSeconds();
+        for (int q = 0; q < world->queryCount; q++) {
+            if (kind == QUERY_AABB) sink += BruteQueryAabb(world, world->boxes[q], BVH_ALL_TYPES, indices, world->count);
+            else {
+                const BvhRay *r = &world->rays[q];
+                const BvhSegment *s = &world->segments[q];
+                const BvhSweep *w = &world->sweeps[q];
+                BvhHit hit = (kind == QUERY_RAY) ? BruteCast(world, r->origin, r->direction, r->maxT, 0.0f, 0.0f, BVH_ALL_TYPES) :
+                             (kind == QUERY_SEGMENT) ? BruteCast(world, s->start, (Vector2){ s->end.x - s->start.x, s->end.y - s->start.y }, 1.0f, 0.0f, 0.0f, BVH_ALL_TYPES) :
+                             BruteCast(world, (Vector2){ w->box.x + w->box.width*0.5f, w->box.y + w->box.height*0.5f }, w->delta, 1.0f, w->box.width*0.5f, w->box.height*0.5f, BVH_ALL_TYPES);
+                sink += hit.index;
+            }
+        }
+        double bruteSeconds = NowSeconds() - start;
+
+        double bvhRate = world->queryCount/((bvhSeconds > 0.0) ? bvhSeconds : 1e-9);
+        double bruteRate = world->queryCount/((bruteSeconds > 0.0) ? bruteSeconds : 1e-9);
+        printf("%-8s %16.0f %16.0f %9.1fx\n", queryNames[kind], bvhRate, bruteRate, bvhRate/bruteRate);
+    }
+    free(indices);
+    free(hits);
+}
+
+int main(int argc, char **argv)
+{
+    int count = 2000;
+    int queryCount = 20000;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--count") == 0) count = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--queries") == 0) queryCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+    }
+    if (count < 1) count = 1;
+    if (queryCount < 1) queryCount = 1;
+
+    TestWorld world = GenerateWorld(count, queryCount, seed);
+    PlatformBvh bvh = LoadPlatformBvh(world.rects, world.types, world.count);
+    printf("%d rectangles, %d queries of each kind, seed %llu, %d nodes\n", count, queryCount, (unsigned long long)seed, bvh.nodeCount);
+
+    int mismatches[QUERY_KIND_COUNT] = { 0 };
+    int total = CheckWorld(&bvh, &world, mismatches);
+    for (int kind = 0; kind < QUERY_KIND_COUNT; kind++) printf("  %-8s %s (%d mismatches)\n", queryNames[kind], (mismatches[kind] == 0) ? "ok" : "FAILED", mismatches[kind]);
+
+    Benchmark(&bvh, &world);
+
+    UnloadPlatformBvh(bvh);
+    UnloadWorld(world);
+    return (total == 0) ? 0 : 1;
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <time.h> // Seed по умолчанию
 /*******************************************************************************************
 *
 *   raylib [core] example - 2D Camera platformer + Dust Particles + JumpThru Platforms
@@ -10,64 +11,170 @@
 
 #include "raylib.h" // Подключение библиотеки raylib
 #include "raymath.h" // Подключение библиотеки raymath
+#define PLATFORM_BVH_IMPLEMENTATION
+#define PLATFORM_DYNTREE_IMPLEMENTATION
+#define PLATFORMER_SIM_IMPLEMENTATION
+#include "platformer_sim.h" // Уровень, игрок и физика (BVH и дерево подвижных платформ)
+#define TELEMETRY_IMPLEMENTATION
+#include "telemetry.h" // Гистограммы для долгих прогонов
+#define RNG_STREAM_IMPLEMENTATION
+#include "rng_stream.h" // Воспроизводимые потоки случайных чисел
+#define STATE_TRACE_IMPLEMENTATION
+#include "state_trace.h" // Запись состояния по тикам
 #define PLAYER_SPRITE_PATH "resources/player.png"
 Texture2D playerTexture;
 
-// --- Константы игрока ---
-#define G 950 // Гравитация
-#define PLAYER_JUMP_SPD 350.0f // Скорость прыжка игрока
-#define PLAYER_MAX_SPEED 500.0f // Максимальная горизонтальная скорость игрока
-#define PLAYER_ACCELERATION 400.0f // Ускорение игрока
-#define PLAYER_DECELERATION 450.0f // Замедление игрока
-#define PLAYER_MAX_JUMP_TIME 0.40f // Максимальное время удержания прыжка
-#define PLAYER_JUMP_HOLD_FORCE 500.0f // Сила удержания прыжка
-#define PLAYER_DASH_SPEED 900.0f // Скорость рывка
-#define PLAYER_DASH_TIME 0.18f   // Длительность рывка (сек)
+PlatformBvh envBvh = {0}; // BVH по платформам уровня (строится один раз при старте)
+PlayerTuning playerTuning = {0}; // Текущие константы игрока
+
+// --- Телеметрия (включается аргументом --telemetry <файл>) ---
+#define TELEMETRY_FLUSH_INTERVAL 5.0f // Период сброса записи (сек)
+Telemetry telemetry = {0}; // Без файла запись выключена
+
+// --- Трасса состояния (--trace <файл> пишет, --ghost <файл> показывает призрака) ---
+TraceWriter traceWriter = {0}; // Без файла запись выключена
+double traceWriteSeconds = 0.0; // Суммарное время записи (для оценки накладных расходов)
+TraceReader ghostTrace = {0};  // Трасса призрака
+bool ghostLoaded = false;      // Призрак загружен
+TraceFrame ghostFrame = {0};   // Текущее состояние призрака
+TraceFrame ghostNext = {0};    // Следующий тик призрака
+bool ghostHasNext = false;     // Есть ли следующий тик
+float ghostElapsed = 0.0f;     // Время с начала забега
+float ghostNextTime = 0.0f;    // Момент следующего тика призрака
+
+// --- Случайные числа: свой поток на подсистему (seed задаётся аргументом --seed <число>) ---
+typedef enum {
+    RNG_STREAM_DUST = 0,  // Пыль
+    RNG_STREAM_SHAKE      // Скриншейк
+} RngStreamId;
+RngStream dustRng = {0};  // Поток для пыли
+RngStream shakeRng = {0}; // Поток для скриншейка
 
 // --- Константы скриншейка ---
 #define SCREEN_SHAKE_DURATION 0.3f // Длительность скриншейка
 #define SCREEN_SHAKE_INTENSITY 20.0f // Интенсивность скриншейка
 
-// --- Типы платформ ---
-typedef enum { PLATFORM_NONE = 0, PLATFORM_SOLID = 1, PLATFORM_JUMPTHRU = 2 } PlatformType; // Типы платформ
-
-// --- Структура игрока ---
-typedef struct Player {
-    Vector2 position;   // Центр ног игрока
-    float speed;        // Вертикальная скорость
-    float velocityX;    // Горизонтальная скорость
-    bool canJump;       // Может прыгать
-    float jumpTime;     // Время удержания прыжка
-    bool isJumping;     // Сейчас прыгает
-    bool dropDown;      // Флаг: инициировано спрыгивание с JumpThru
-    int jumpCount;      // Счетчик прыжков для распрыжки
-    bool dashing;       // Сейчас выполняется рывок
-    float dashTime;     // Оставшееся время рывка
-    bool isSuperJump;   // Флаг супер-прыжка
-    bool wasSuperJump;  // Флаг: был ли последний прыжок супер-прыжком
-    int lastDirection;  // Последнее направление движения: 1 — вправо, -1 — влево
-    bool superJumpWasInAir; // Был ли в воздухе после супер-прыжка
-} Player;
-
-// --- Структура платформы ---
-typedef struct EnvItem {
-    Rectangle rect;     // Прямоугольник платформы
-    PlatformType type;  // Тип платформы
-    Color color;        // Цвет платформы
-} EnvItem;
-
- // --- Уровень: добавлен JumpThru справа от оранжевой платформы ---
-    EnvItem envItems[] = {
-        {{ 0, 0,  1000,   400 },      PLATFORM_NONE,    LIGHTGRAY }, // Фон
-        {{ 0, 400, 5000, 200 }, PLATFORM_SOLID, GRAY },             // Земля
-        {{ 0, -10, 50, 2000 }, PLATFORM_SOLID, GRAY },              // Левая стена
-        {{ 300, 200, 400, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
-        {{ 250, 300, 100, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
-        {{ 650, 300, 100, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
-        {{ 800, 300, 100, 20 }, PLATFORM_SOLID, ORANGE },           // Оранжевая платформа
-        {{ 950, 320, 120, 10 }, PLATFORM_JUMPTHRU, VIOLET }         // JumpThru-платформа
-    };
-    int envItemsLength = sizeof(envItems)/sizeof(envItems[0]); // Количество платформ
+// --- Подвижные платформы ---
+#define MAX_DYNAMIC_PLATFORMS 4096 // Максимальное количество подвижных платформ
+#define FALLING_PLATFORM_DELAY 0.5f // Задержка перед падением (сек)
+#define FALLING_PLATFORM_MAX_DROP 1500.0f // Падение, после которого платформа исчезает
+#define CRUMBLING_PLATFORM_DELAY 0.6f // Время до разрушения (сек)
+#define DYNAMIC_PLATFORM_RESPAWN_TIME 3.0f // Время до возрождения (сек)
+#define STRESS_PLATFORMS_COUNT 3000 // Платформ в стресс-тесте (клавиша B)
+
+DynamicPlatform dynamicPlatforms[MAX_DYNAMIC_PLATFORMS] = {0}; // Массив подвижных платформ
+int dynamicPlatformsLength = 0; // Количество подвижных платформ
+DynTree dynamicTree = {0}; // Дерево подвижных платформ
+double dynamicPlatformsTime = 0.0; // Общее время для MOTION_PATH (double: float грубеет за часы работы)
+
+// Добавление подвижной платформы (возвращает индекс или -1)
+int AddDynamicPlatform(Rectangle rect, PlatformType type, Color color, PlatformMotion motion, Vector2 amplitude, float period, float phase)
+{
+    if (dynamicPlatformsLength >= MAX_DYNAMIC_PLATFORMS) return -1;
+    int index = dynamicPlatformsLength++;
+    DynamicPlatform *p = &dynamicPlatforms[index];
+    *p = (DynamicPlatform){ 0 };
+    p->item = (EnvItem){ rect, type, color };
+    p->motion = motion;
+    p->origin = (Vector2){ rect.x, rect.y };
+    p->amplitude = amplitude;
+    p->period = period;
+    p->phase = phase;
+    p->active = true;
+    p->proxy = CreateDynTreeProxy(&dynamicTree, BvhAabbFromRec(rect), BVH_TYPE_BIT(type), index);
+    return index;
+}
+
+// Удаление последних платформ, начиная с индекса first (игрок на удалённой платформе с неё сходит)
+void TruncateDynamicPlatforms(int first, Player *player)
+{
+    for (int i = first; i < dynamicPlatformsLength; i++) {
+        if (dynamicPlatforms[i].proxy != DYNTREE_NULL) DestroyDynTreeProxy(&dynamicTree, dynamicPlatforms[i].proxy);
+        dynamicPlatforms[i].proxy = DYNTREE_NULL;
+        dynamicPlatforms[i].active = false;
+    }
+    if (player->groundPlatform >= first) player->groundPlatform = -1;
+    if (player->dropDown && player->dropDynamic && player->dropPlatform >= first) player->dropDown = false;
+    if (first < dynamicPlatformsLength) dynamicPlatformsLength = first;
+}
+
+// Обновление подвижных платформ: в дереве переставляются только вышедшие за свой толстый прямоугольник
+void UpdateDynamicPlatforms(float dt)
+{
+    dynamicPlatformsTime += dt;
+    for (int i = 0; i < dynamicPlatformsLength; i++) {
+        DynamicPlatform *p = &dynamicPlatforms[i];
+        Vector2 oldPos = { p->item.rect.x, p->item.rect.y };
+        Vector2 newPos = oldPos;
+
+        if (!p->active) {
+            // Ждём возрождения на исходном месте
+            p->timer += dt;
+            if (p->timer >= DYNAMIC_PLATFORM_RESPAWN_TIME) {
+                p->item.rect.x = p->origin.x;
+                p->item.rect.y = p->origin.y;
+                p->timer = 0.0f;
+                p->fallSpeed = 0.0f;
+                p->triggered = false;
+                p->active = true;
+                p->proxy = CreateDynTreeProxy(&dynamicTree, BvhAabbFromRec(p->item.rect), BVH_TYPE_BIT(p->item.type), i);
+            }
+            p->delta = (Vector2){ 0 };
+            continue;
+        }
+
+        if (p->motion == MOTION_PATH) {
+            double cycles = dynamicPlatformsTime/p->period + p->phase;
+            float angle = 2.0f*PI*(float)(cycles - floor(cycles)); // Только доля периода, чтобы sinf не терял точность
+            newPos.x = p->origin.x + p->amplitude.x*sinf(angle);
+            newPos.y = p->origin.y + p->amplitude.y*sinf(angle);
+        } else if (p->triggered) {
+            p->timer += dt;
+            if (p->motion == MOTION_FALLING && p->timer >= FALLING_PLATFORM_DELAY) {
+                p->fallSpeed += playerTuning.gravity*dt;
+                newPos.y += p->fallSpeed*dt;
+            }
+            bool gone = (p->motion == MOTION_FALLING) ? (newPos.y - p->origin.y > FALLING_PLATFORM_MAX_DROP) : (p->timer >= CRUMBLING_PLATFORM_DELAY);
+            if (gone) {
+                DestroyDynTreeProxy(&dynamicTree, p->proxy);
+                p->proxy = DYNTREE_NULL;
+                p->active = false;
+                p->timer = 0.0f;
+                p->delta = (Vector2){ 0 };
+                continue;
+            }
+        }
+
+        p->delta = (Vector2){ newPos.x - oldPos.x, newPos.y - oldPos.y };
+        p->item.rect.x = newPos.x;
+        p->item.rect.y = newPos.y;
+        if (p->delta.x != 0.0f || p->delta.y != 0.0f)
+            MoveDynTreeProxy(&dynamicTree, p->proxy, BvhAabbFromRec(p->item.rect), p->delta);
+    }
+}
+
+// Рисование подвижных платформ (разрушающиеся бледнеют перед исчезновением)
+void DrawDynamicPlatforms(void)
+{
+    for (int i = 0; i < dynamicPlatformsLength; i++) {
+        const DynamicPlatform *p = &dynamicPlatforms[i];
+        if (!p->active) continue;
+        Color color = p->item.color;
+        if (p->motion == MOTION_CRUMBLING && p->triggered) color = Fade(color, 1.0f - 0.7f*p->timer/CRUMBLING_PLATFORM_DELAY);
+        DrawRectangleRec(p->item.rect, color);
+    }
+}
+
+// Поле из множества качающихся JumpThru платформ над уровнем — нагрузочный тест дерева
+void AddStressPlatforms(int count)
+{
+    int columns = 60;
+    for (int i = 0; i < count; i++) {
+        Rectangle rect = { 1200.0f + (i%columns)*60.0f, -200.0f - (i/columns)*40.0f, 40.0f, 8.0f };
+        Vector2 amplitude = { (i%3 == 0) ? 25.0f : 0.0f, (i%3 == 0) ? 0.0f : 15.0f };
+        AddDynamicPlatform(rect, PLATFORM_JUMPTHRU, SKYBLUE, MOTION_PATH, amplitude, 2.0f + (i%7)*0.5f, (i%11)/11.0f);
+    }
+}
 
 // --- Частицы пыли ---
 #define MAX_PARTICLES 2000 // Максимальное количество частиц
@@ -81,6 +188,19 @@ typedef struct Particle {
     Color color; // Цвет частицы
 } Particle;
 Particle particles[MAX_PARTICLES] = {0}; // Массив частиц
+BvhRay particleRays[MAX_PARTICLES];      // Лучи вниз от частиц для поиска земли
+BvhHit particleHits[MAX_PARTICLES];      // Результаты лучей
+int particleRayOwner[MAX_PARTICLES];     // Индекс частицы для каждого луча
+
+// Случайные параметры выброса пыли (поле - массив, заполняется одним пакетом)
+typedef struct DustBatch {
+    int offsetX[MAX_PARTICLES];  // Разброс по X
+    int offsetY[MAX_PARTICLES];  // Разброс по Y
+    int angleDeg[MAX_PARTICLES]; // Угол разлёта (градусы)
+    int speed[MAX_PARTICLES];    // Скорость (сотые)
+    int size[MAX_PARTICLES];     // Размер
+} DustBatch;
+DustBatch dustBatch; // Пакет для текущего выброса
 
 // --- Глобальные переменные для скриншейка ---
 float screenShakeTime = 0.0f;
@@ -121,9 +241,66 @@ int convex_hull(const HullPoint *points, int n, HullPoint *hull) {
     return k-1;
 }
 
+// --- Заполнение пакета параметров пыли (те же диапазоны, что были у GetRandomValue) ---
+void FillDustBatch(RngStream *rng, DustBatch *batch, int count)
+{
+    RngFillInts(rng, batch->offsetX, count, -30, 30);  // Больший разброс по X
+    RngFillInts(rng, batch->offsetY, count, -8, 8);    // и по Y
+    RngFillInts(rng, batch->angleDeg, count, 120, 420); // Веерный угол разлёта
+    RngFillInts(rng, batch->speed, count, 60, 160);
+    RngFillInts(rng, batch->size, count, 10, 20);
+}
+
+// --- Состояние тика для трассы ---
+TraceFrame MakeTraceFrame(const Player *player, Camera2D camera, int cameraMode, float dt)
+{
+    TraceFrame frame = {0};
+    frame.values[TRACE_DT_US] = TraceQuantize(TRACE_DT_US, dt);
+    frame.values[TRACE_POSITION_X] = TraceQuantize(TRACE_POSITION_X, player->position.x);
+    frame.values[TRACE_POSITION_Y] = TraceQuantize(TRACE_POSITION_Y, player->position.y);
+    frame.values[TRACE_SPEED] = TraceQuantize(TRACE_SPEED, player->speed);
+    frame.values[TRACE_VELOCITY_X] = TraceQuantize(TRACE_VELOCITY_X, player->velocityX);
+    frame.values[TRACE_JUMP_COUNT] = player->jumpCount;
+    frame.values[TRACE_DASH_TIME] = TraceQuantize(TRACE_DASH_TIME, player->dashTime);
+    frame.values[TRACE_FLAGS] = (player->canJump ? TRACE_FLAG_CAN_JUMP : 0) | (player->isJumping ? TRACE_FLAG_JUMPING : 0) |
+                                (player->dashing ? TRACE_FLAG_DASHING : 0) | (player->isSuperJump ? TRACE_FLAG_SUPER_JUMP : 0) |
+                                (player->dropDown ? TRACE_FLAG_DROP_DOWN : 0) | (player->wasOnGround ? TRACE_FLAG_ON_GROUND : 0) |
+                                (player->lastDirection == -1 ? TRACE_FLAG_FACING_LEFT : 0);
+    frame.values[TRACE_CAMERA_TARGET_X] = TraceQuantize(TRACE_CAMERA_TARGET_X, camera.target.x);
+    frame.values[TRACE_CAMERA_TARGET_Y] = TraceQuantize(TRACE_CAMERA_TARGET_Y, camera.target.y);
+    frame.values[TRACE_CAMERA_OFFSET_X] = TraceQuantize(TRACE_CAMERA_OFFSET_X, camera.offset.x);
+    frame.values[TRACE_CAMERA_OFFSET_Y] = TraceQuantize(TRACE_CAMERA_OFFSET_Y, camera.offset.y);
+    frame.values[TRACE_CAMERA_ZOOM] = TraceQuantize(TRACE_CAMERA_ZOOM, camera.zoom);
+    frame.values[TRACE_CAMERA_MODE] = cameraMode;
+    return frame;
+}
+
+// --- Призрак: забег воспроизводится по времени, а не по номеру тика ---
+void RestartGhost(void)
+{
+    if (!ghostLoaded) return;
+    ghostElapsed = 0.0f;
+    ghostHasNext = TraceSeek(&ghostTrace, 0) && TraceReadFrame(&ghostTrace, &ghostNext);
+    ghostFrame = ghostNext;
+    ghostNextTime = ghostHasNext ? TraceDequantize(TRACE_DT_US, ghostNext.values[TRACE_DT_US]) : 0.0f;
+}
+
+void UpdateGhost(float dt)
+{
+    if (!ghostLoaded) return;
+    ghostElapsed += dt;
+    while (ghostHasNext && ghostElapsed >= ghostNextTime) {
+        ghostFrame = ghostNext;
+        ghostHasNext = TraceReadFrame(&ghostTrace, &ghostNext); // В конце трассы призрак остаётся на месте
+        if (ghostHasNext) ghostNextTime += TraceDequantize(TRACE_DT_US, ghostNext.values[TRACE_DT_US]);
+    }
+}
+
 // --- Функция спавна пыли ---
 void SpawnDustParticles(Vector2 pos, int count)
 {
+    if (count > MAX_PARTICLES) count = MAX_PARTICLES;
+    FillDustBatch(&dustRng, &dustBatch, count); // Все случайные числа выброса одним пакетом
     for (int c = 0; c < count; c++)
     {
         int slot = -1;
@@ -132,18 +309,14 @@ void SpawnDustParticles(Vector2 pos, int count)
             if (!particles[i].active) { slot = i; break; }
             if (particles[i].life < minLife) { minLife = particles[i].life; slot = i; }
         }
-        // Больший разброс по X и Y
-        float offsetX = GetRandomValue(-30, 30);
-        float offsetY = GetRandomValue(-8, 8);
-        Vector2 spawnPos = (Vector2){ pos.x + offsetX, pos.y + offsetY };
-        // Веерный угол разлёта
-        float angle = DEG2RAD * (GetRandomValue(120, 420));
-        float speed = GetRandomValue(60, 160) / 100.0f;
+        Vector2 spawnPos = (Vector2){ pos.x + dustBatch.offsetX[c], pos.y + dustBatch.offsetY[c] };
+        float angle = DEG2RAD * dustBatch.angleDeg[c];
+        float speed = dustBatch.speed[c] / 100.0f;
         particles[slot].pos = spawnPos;
         particles[slot].vel = (Vector2){ cosf(angle) * speed, -fabsf(sinf(angle) * speed) };
         particles[slot].life = 1.2f;
         particles[slot].maxLife = 1.2f;
-        particles[slot].size = GetRandomValue(10, 20);
+        particles[slot].size = dustBatch.size[c];
         particles[slot].active = true;
         // Случайный оттенок серого/коричневого
         particles[slot].color = (Color){ 255, 255, 255, 180 }; // Белый с альфой 180
@@ -155,31 +328,36 @@ void UpdateParticles(float dt)
 {
     // Высота платформы (земли) — ищем самую верхнюю SOLID платформу под частицей
     extern EnvItem envItems[];
-    extern int envItemsLength;
+    int rayCount = 0;
     for (int i = 0; i < MAX_PARTICLES; i++) {
         if (particles[i].active) {
             particles[i].pos.x += particles[i].vel.x * 80.0f * dt;
             particles[i].pos.y += particles[i].vel.y * 80.0f * dt;
             // Слабая гравитация
             particles[i].vel.y += 0.18f * dt;
-            // Проверяем, не ниже ли частица платформы
-            float groundY = 1e9f;
-            for (int j = 0; j < envItemsLength; j++) {
-                if (envItems[j].type == PLATFORM_SOLID) {
-                    Rectangle r = envItems[j].rect;
-                    if (particles[i].pos.x >= r.x && particles[i].pos.x <= r.x + r.width) {
-                        if (r.y < groundY && particles[i].pos.y <= r.y + 2.0f) groundY = r.y;
-                    }
-                }
-            }
+            // Луч вниз с допуском 2 пикселя: первая SOLID платформа, верх которой не выше частицы
+            particleRays[rayCount] = (BvhRay){ { particles[i].pos.x, particles[i].pos.y - 2.0f }, { 0.0f, 1.0f }, INFINITY };
+            particleRayOwner[rayCount] = i;
+            rayCount++;
+        }
+    }
+
+    // Все лучи одним пакетом
+    RaycastPlatformBvhBatch(&envBvh, particleRays, rayCount, BVH_TYPE_BIT(PLATFORM_SOLID), particleHits);
+
+    for (int r = 0; r < rayCount; r++) {
+        int i = particleRayOwner[r];
+        // Проверяем, не ниже ли частица платформы
+        if (particleHits[r].index >= 0) {
+            float groundY = envItems[particleHits[r].index].rect.y;
             if (particles[i].pos.y > groundY) {
                 particles[i].pos.y = groundY;
                 particles[i].vel.y = 0;
             }
-            particles[i].life -= dt;
-            if (particles[i].life <= 0.0f)
-                particles[i].active = false;
         }
+        particles[i].life -= dt;
+        if (particles[i].life <= 0.0f)
+            particles[i].active = false;
     }
 }
 
@@ -214,14 +392,14 @@ void DrawParticles(void)
 }
 
 // --- Прототипы функций управления игроком и камерой ---
-void UpdatePlayer(Player *player, EnvItem *envItems, int envItemsLength, float delta, bool *justLanded, bool *justLandedSuperJump, Vector2 *landPos); // Обновление состояния игрока
+PlayerInput ReadPlayerInput(void); // Ввод игрока с клавиатуры
 void UpdateCameraCenter(Camera2D *camera, Player *player, EnvItem *envItems, int envItemsLength, float delta, int width, int height); // Камера по центру игрока
 void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player, EnvItem *envItems, int envItemsLength, float delta, int width, int height); // Камера по центру, но в пределах карты
 void UpdateCameraCenterSmoothFollow(Camera2D *camera, Player *player, EnvItem *envItems, int envItemsLength, float delta, int width, int height); // Плавное следование камеры
 void UpdateCameraEvenOutOnLanding(Camera2D *camera, Player *player, EnvItem *envItems, int envItemsLength, float delta, int width, int height); // Камера выравнивается после приземления
 void UpdateCameraPlayerBoundsPush(Camera2D *camera, Player *player, EnvItem *envItems, int envItemsLength, float delta, int width, int height); // Камера сдвигается, если игрок у края
 
-int main(void)
+int main(int argc, char **argv)
 {
     const int screenWidth = 1600; // Ширина окна
     const int screenHeight = 800; // Высота окна
@@ -230,21 +408,43 @@ int main(void)
 
     playerTexture = LoadTexture(PLAYER_SPRITE_PATH); // Загружаем спрайт игрока
 
-    Player player = {0}; // Создание структуры игрока и обнуление
-    player.position = (Vector2){ 400, 280 }; // Начальная позиция игрока
-    player.speed = 0; // Начальная вертикальная скорость
-    player.velocityX = 0; // Начальная горизонтальная скорость
-    player.canJump = false; // Может ли прыгать
-    player.jumpTime = 0.0f; // Время удержания прыжка
-    player.isJumping = false; // Прыгает ли сейчас
-    player.dropDown = false; // Флаг спрыгивания с JumpThru
-    player.jumpCount = 0; // Счетчик прыжков для распрыжки
-    player.dashing = false; // Не в рывке
-    player.dashTime = 0.0f; // Таймер рывка
-    player.isSuperJump = false; // Флаг супер-прыжка
-    player.wasSuperJump = false; // Флаг: был ли последний прыжок супер-прыжком
-    player.lastDirection = 1; // По умолчанию смотрит вправо
-    player.superJumpWasInAir = false;
+    // Аргумент --telemetry <файл>: запись гистограмм для долгих прогонов
+    const char *telemetryPath = NULL;
+    for (int i = 1; i + 1 < argc; i++) if (strcmp(argv[i], "--telemetry") == 0) telemetryPath = argv[i + 1];
+
+    // Аргумент --seed <число>: повторяемые пыль и скриншейк (по умолчанию от времени)
+    uint64_t rngSeed = (uint64_t)time(NULL);
+    for (int i = 1; i + 1 < argc; i++) if (strcmp(argv[i], "--seed") == 0) rngSeed = strtoull(argv[i + 1], NULL, 10);
+    dustRng = CreateRngStream(rngSeed, RNG_STREAM_DUST);
+    shakeRng = CreateRngStream(rngSeed, RNG_STREAM_SHAKE);
+    TraceLog(LOG_INFO, "RNG: Seed %llu", (unsigned long long)rngSeed);
+
+    // Аргументы --trace <файл> и --ghost <файл>: запись забега и призрак прошлого забега
+    const char *tracePath = NULL;
+    const char *ghostPath = NULL;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+        if (strcmp(argv[i], "--ghost") == 0) ghostPath = argv[i + 1];
+    }
+    if (tracePath != NULL && !OpenTraceWriter(&traceWriter, tracePath)) TraceLog(LOG_WARNING, "TRACE: Failed to open %s", tracePath);
+    if (ghostPath != NULL) {
+        ghostLoaded = OpenTraceReader(&ghostTrace, ghostPath);
+        if (ghostLoaded) RestartGhost();
+        else TraceLog(LOG_WARNING, "TRACE: Failed to load ghost %s", ghostPath);
+    }
+    envBvh = LoadEnvItemsBvh(envItems, envItemsLength); // Строим BVH по платформам
+
+    // Подвижные платформы справа от JumpThru
+    dynamicTree = LoadDynTree(2*MAX_DYNAMIC_PLATFORMS);
+    AddDynamicPlatform((Rectangle){ 1150, 300, 100, 10 }, PLATFORM_SOLID, DARKBLUE, MOTION_PATH, (Vector2){ 120, 0 }, 4.0f, 0.0f);   // Качается по горизонтали
+    AddDynamicPlatform((Rectangle){ 1450, 250, 100, 10 }, PLATFORM_JUMPTHRU, VIOLET, MOTION_PATH, (Vector2){ 0, 80 }, 3.0f, 0.0f);   // Качается по вертикали
+    AddDynamicPlatform((Rectangle){ 1650, 300, 100, 10 }, PLATFORM_SOLID, BROWN, MOTION_FALLING, (Vector2){ 0 }, 0.0f, 0.0f);       // Падает
+    AddDynamicPlatform((Rectangle){ 1850, 280, 100, 10 }, PLATFORM_SOLID, BEIGE, MOTION_CRUMBLING, (Vector2){ 0 }, 0.0f, 0.0f);     // Рассыпается
+    int levelDynamicPlatforms = dynamicPlatformsLength; // Платформы уровня (без стресс-теста)
+    double dynamicUpdateMs = 0.0; // Время обновления подвижных платформ за кадр
+
+    playerTuning = DefaultPlayerTuning(); // Константы игрока по умолчанию
+    Player player = CreatePlayer((Vector2){ 400, 280 }); // Создание игрока в начальной позиции
 
    
 
@@ -273,30 +473,38 @@ int main(void)
         "Player push camera on getting too close to screen edge"
     }; // Описания режимов камеры
 
+    if (telemetryPath != NULL && !OpenTelemetry(&telemetry, telemetryPath, TELEMETRY_FLUSH_INTERVAL, cameraUpdatersLength))
+        TraceLog(LOG_WARNING, "TELEMETRY: Failed to open %s", telemetryPath);
+
     SetTargetFPS(144); // 144 кадров в секунду
 
     while (!WindowShouldClose())
     {
         float deltaTime = GetFrameTime();
 
-        // --- Спрыгивание с JumpThru: если стоим и нажали вниз+пробел, активируем dropDown и НЕ прыгаем! ---
-        if (IsKeyDown(KEY_DOWN) && IsKeyPressed(KEY_SPACE))
-        {
-            player.dropDown = true;
-            player.isJumping = false; // Отключаем прыжок!
-            player.jumpTime = 0.0f;
-            player.canJump = false;
-            player.speed = 200.0f; // Даем значительную скорость вниз для проваливания
+        // Нагрузочный тест: тысячи качающихся платформ
+        if (IsKeyPressed(KEY_B)) {
+            if (dynamicPlatformsLength > levelDynamicPlatforms) TruncateDynamicPlatforms(levelDynamicPlatforms, &player);
+            else AddStressPlatforms(STRESS_PLATFORMS_COUNT);
         }
 
+        double dynamicUpdateStart = GetTime();
+        dynamicTree.reinsertCount = 0;
+        UpdateDynamicPlatforms(deltaTime);
+        dynamicUpdateMs = (GetTime() - dynamicUpdateStart)*1000.0;
+
         bool justLanded = false;
         bool justLandedSuperJump = false;
         Vector2 landPos = {0,0};
-        UpdatePlayer(&player, envItems, envItemsLength, deltaTime, &justLanded, &justLandedSuperJump, &landPos);
+        UpdatePlayer(&player, &playerTuning, ReadPlayerInput(), envItems, &envBvh, dynamicPlatforms, &dynamicTree, deltaTime, &justLanded, &justLandedSuperJump, &landPos);
+
+        // Падающие и рассыпающиеся платформы срабатывают, когда на них стоят
+        if (player.groundPlatform >= 0) dynamicPlatforms[player.groundPlatform].triggered = true;
 
         if (justLanded) {
             int dustCount = justLandedSuperJump ? 100 : 24;
             SpawnDustParticles((Vector2){player.position.x, player.position.y+1}, dustCount);
+            TelemetryRecord(&telemetry, TELEMETRY_SPAWN_BURST, dustCount);
         }
 
         UpdateParticles(deltaTime);
@@ -312,7 +520,7 @@ int main(void)
             } else {
                 cameraTargetZoom = 1.7f; // Обычное отдаление для обычного прыжка
             }
-        } else if (fabs(player.velocityX) >= PLAYER_MAX_SPEED) { // Если на земле и на максимальной скорости
+        } else if (fabs(player.velocityX) >= playerTuning.maxSpeed) { // Если на земле и на максимальной скорости
             cameraTargetZoom = 1.7f;
         } else {
             cameraTargetZoom = 2.0f; // Вернуть камеру при приземлении и обычной скорости
@@ -325,12 +533,28 @@ int main(void)
         {
             camera.zoom = 2.0f;
             player.position = (Vector2){ 400, 280 };
+            RestartGhost(); // Призрак стартует заново вместе с игроком
         }
 
         if (IsKeyPressed(KEY_C)) cameraOption = (cameraOption + 1)%cameraUpdatersLength;
 
         cameraUpdaters[cameraOption](&camera, &player, envItems, envItemsLength, deltaTime, screenWidth, screenHeight);
 
+        // Трасса состояния и призрак
+        if (traceWriter.file != NULL) {
+            double traceStart = GetTime();
+            TraceFrame traceFrame = MakeTraceFrame(&player, camera, cameraOption, deltaTime);
+            TraceWriteFrame(&traceWriter, &traceFrame);
+            traceWriteSeconds += GetTime() - traceStart;
+        }
+        UpdateGhost(deltaTime);
+
+        // Телеметрия кадра
+        TelemetryRecord(&telemetry, TELEMETRY_FRAME_TIME_US, (uint32_t)(deltaTime*1000000.0f));
+        TelemetryRecord(&telemetry, TELEMETRY_COLLISION_CANDIDATES, player.collisionCandidates);
+        TelemetryCameraTime(&telemetry, cameraOption, deltaTime);
+        TelemetryUpdate(&telemetry, deltaTime);
+
         // Обновление скриншейка
         if (screenShakeTime > 0.0f) {
             screenShakeTime -= deltaTime;
@@ -349,13 +573,14 @@ int main(void)
 
                 // Применяем скриншейк к камере
                 if (screenShakeTime > 0.0f) {
-                    float shakeX = GetRandomValue(-screenShakeIntensity, screenShakeIntensity);
-                    float shakeY = GetRandomValue(-screenShakeIntensity, screenShakeIntensity);
+                    float shakeX = RngNextInt(&shakeRng, -(int)screenShakeIntensity, (int)screenShakeIntensity);
+                    float shakeY = RngNextInt(&shakeRng, -(int)screenShakeIntensity, (int)screenShakeIntensity);
                     camera.offset.x = originalCameraOffset.x + shakeX;
                     camera.offset.y = originalCameraOffset.y + shakeY;
                 }
 
                 for (int i = 0; i < envItemsLength; i++) DrawRectangleRec(envItems[i].rect, envItems[i].color);
+                DrawDynamicPlatforms();
 
                 // Отрисовка спрайта игрока по центру ног с сохранением пропорций и отражением по направлению
                 int targetW = 40;
@@ -371,6 +596,16 @@ int main(void)
                 Vector2 origin = { 0, 0 };
                 DrawTexturePro(playerTexture, srcRect, destRect, origin, 0.0f, WHITE);
 
+                // Полупрозрачный призрак записанного забега
+                if (ghostLoaded) {
+                    Vector2 ghostPos = { TraceDequantize(TRACE_POSITION_X, ghostFrame.values[TRACE_POSITION_X]), TraceDequantize(TRACE_POSITION_Y, ghostFrame.values[TRACE_POSITION_Y]) };
+                    Rectangle ghostSrc = srcRect;
+                    ghostSrc.width = (ghostFrame.values[TRACE_FLAGS] & TRACE_FLAG_FACING_LEFT) ? -playerTexture.width : playerTexture.width;
+                    ghostSrc.x = (ghostSrc.width < 0) ? playerTexture.width : 0;
+                    Rectangle ghostDest = { ghostPos.x - targetW/2, ghostPos.y - targetH, targetW, targetH };
+                    DrawTexturePro(playerTexture, ghostSrc, ghostDest, origin, 0.0f, Fade(SKYBLUE, 0.5f));
+                }
+
                 DrawCircleV(player.position, 5.0f, GOLD);
 
                 DrawParticles();
@@ -394,10 +629,29 @@ int main(void)
             // Отображение количества активных частиц
             int activeParticles = 0;
             for (int i = 0; i < MAX_PARTICLES; i++) if (particles[i].active) activeParticles++;
+            TelemetryRecord(&telemetry, TELEMETRY_ACTIVE_PARTICLES, activeParticles);
             char particleCountText[64];
             snprintf(particleCountText, sizeof(particleCountText), "Active particles: %d", activeParticles);
             DrawText(particleCountText, 40, 200, 10, DARKGRAY);
 
+            // Подвижные платформы: количество, перестановки в дереве и время обновления
+            char dynamicText[128];
+            snprintf(dynamicText, sizeof(dynamicText), "Dynamic platforms: %d (B - stress test), tree reinserts: %d, update: %.3f ms",
+                     dynamicPlatformsLength, dynamicTree.reinsertCount, dynamicUpdateMs);
+            DrawText(dynamicText, 40, 220, 10, DARKGRAY);
+
+            // Трасса: размер и средняя цена записи тика; призрак: позиция в забеге
+            if (traceWriter.file != NULL || ghostLoaded) {
+                char traceText[160];
+                int traceLength = 0;
+                if (traceWriter.file != NULL)
+                    traceLength += snprintf(traceText, sizeof(traceText), "Trace: %u ticks, %.1f KB, %.2f us/tick   ", traceWriter.tickCount,
+                                            (traceWriter.bytesWritten + traceWriter.chunkBytes)/1024.0, (traceWriter.tickCount > 0) ? traceWriteSeconds*1000000.0/traceWriter.tickCount : 0.0);
+                if (ghostLoaded)
+                    snprintf(traceText + traceLength, sizeof(traceText) - traceLength, "Ghost: tick %u/%u (R - restart)", ghostTrace.tick, ghostTrace.tickCount);
+                DrawText(traceText, 40, 240, 10, DARKGRAY);
+            }
+
             {
                 const int fpsFontSize = 20;
                 const int padding = 10;
@@ -413,218 +667,27 @@ int main(void)
 
     CloseWindow();
 
+    CloseTelemetry(&telemetry); // Сбрасываем последний интервал телеметрии
+    CloseTraceWriter(&traceWriter); // Дописываем последний блок трассы
+    if (ghostLoaded) CloseTraceReader(&ghostTrace);
     UnloadTexture(playerTexture); // Освобождаем текстуру игрока
+    UnloadPlatformBvh(envBvh); // Освобождаем BVH
+    UnloadDynTree(dynamicTree); // Освобождаем дерево подвижных платформ
 
     return 0;
 }
 
-// --- Игрок с поддержкой JumpThru платформ и drop-down ---
-void UpdatePlayer(Player *player, EnvItem *envItems, int envItemsLength, float delta, bool *justLanded, bool *justLandedSuperJump, Vector2 *landPos)
+// --- Ввод игрока с клавиатуры ---
+PlayerInput ReadPlayerInput(void)
 {
-    static bool wasOnGround = false;
-
-    // Запоминаем последнее направление ВСЕГДА
-    if (IsKeyDown(KEY_LEFT) && !IsKeyDown(KEY_RIGHT)) player->lastDirection = -1;
-    if (IsKeyDown(KEY_RIGHT) && !IsKeyDown(KEY_LEFT)) player->lastDirection = 1;
-
-    if (!player->dashing && (IsKeyPressed(KEY_LEFT_SHIFT) || IsKeyPressed(KEY_RIGHT_SHIFT))) {
-        // Рывок только если есть движение влево или вправо
-        if (IsKeyDown(KEY_LEFT)) {
-            player->dashing = true;
-            player->dashTime = PLAYER_DASH_TIME;
-            player->velocityX = -PLAYER_DASH_SPEED;
-            player->lastDirection = -1;
-        } else if (IsKeyDown(KEY_RIGHT)) {
-            player->dashing = true;
-            player->dashTime = PLAYER_DASH_TIME;
-            player->velocityX = PLAYER_DASH_SPEED;
-            player->lastDirection = 1;
-        }
-    }
-    if (player->dashing) {
-        player->dashTime -= delta;
-        // Во время рывка игнорируем обычное управление (кроме гравитации и коллизий)
-        if (player->dashTime <= 0.0f) {
-            player->dashing = false;
-            // После рывка скорость сбрасывается к обычной максимальной, если была выше
-            if (player->velocityX > PLAYER_MAX_SPEED) player->velocityX = PLAYER_MAX_SPEED;
-            if (player->velocityX < -PLAYER_MAX_SPEED) player->velocityX = -PLAYER_MAX_SPEED;
-        }
-    } else {
-        // --- Горизонтальное движение ---
-        float targetSpeed = 0.0f;
-        if (IsKeyDown(KEY_LEFT)) targetSpeed -= PLAYER_MAX_SPEED;
-        if (IsKeyDown(KEY_RIGHT)) targetSpeed += PLAYER_MAX_SPEED;
-
-        if (targetSpeed != 0)
-        {
-            if (player->velocityX < targetSpeed)
-            {
-                player->velocityX += PLAYER_ACCELERATION * delta;
-                if (player->velocityX > targetSpeed) player->velocityX = targetSpeed;
-            }
-            else if (player->velocityX > targetSpeed)
-            {
-                player->velocityX -= PLAYER_ACCELERATION * delta;
-                if (player->velocityX < targetSpeed) player->velocityX = targetSpeed;
-            }
-        }
-        else
-        {
-            if (player->velocityX > 0)
-            {
-                player->velocityX -= PLAYER_DECELERATION * delta;
-                if (player->velocityX < 0) player->velocityX = 0;
-            }
-            else if (player->velocityX < 0)
-            {
-                player->velocityX += PLAYER_DECELERATION * delta;
-                if (player->velocityX > 0) player->velocityX = 0;
-            }
-        }
-    }
-
-    // Сброс счетчика прыжков, если персонаж остановился
-    if (player->velocityX == 0) {
-        player->jumpCount = 0;
-    }
-
-    // --- Прыжок с контролем по времени удержания ---
-    if (IsKeyPressed(KEY_SPACE) && player->canJump && !player->dropDown)
-    {
-        float jumpSpeed = -PLAYER_JUMP_SPD;
-        if (fabs(player->velocityX) >= PLAYER_MAX_SPEED) {
-            player->jumpCount++;
-            if (player->jumpCount == 3) {
-                jumpSpeed *= 2.0f; // В 2 раза выше
-                player->jumpCount = 0; // Сбросить счетчик
-                player->isSuperJump = true; // Устанавливаем флаг супер-прыжка
-                player->superJumpWasInAir = true; // Запоминаем, что был супер-прыжок
-            }
-        } else {
-            player->jumpCount = 0; // Если прыжок не на максимальной скорости, сбрасываем счетчик
-            player->isSuperJump = false;
-        }
-        player->speed = jumpSpeed;
-        player->canJump = false;
-        player->isJumping = true;
-        player->jumpTime = 0.0f;
-    }
-
-    if (IsKeyDown(KEY_SPACE) && player->isJumping && player->jumpTime < PLAYER_MAX_JUMP_TIME)
-    {
-        player->speed -= PLAYER_JUMP_HOLD_FORCE * delta;
-        player->jumpTime += delta;
-    }
-    else
-    {
-        player->isJumping = false;
-    }
-
-    // --- Гравитация ---
-    player->speed += G * delta;
-
-    // --- Размеры игрока ---
-    float playerWidth = 40.0f;
-    float playerHeight = 40.0f;
-
-    // --- Сначала движение по X, потом по Y ---
-    // 1. Горизонтальное перемещение и коллизии
-    float newX = player->position.x + player->velocityX * delta;
-    Rectangle newPlayerRectX = { newX - playerWidth/2, player->position.y - playerHeight, playerWidth, playerHeight };
-
-    for (int i = 0; i < envItemsLength; i++)
-    {
-        if (envItems[i].type == PLATFORM_SOLID)
-        {
-            Rectangle envRect = envItems[i].rect;
-            if (CheckCollisionRecs(newPlayerRectX, envRect))
-            {
-                if (player->velocityX > 0)
-                    newX = envRect.x - playerWidth/2;
-                else if (player->velocityX < 0)
-                    newX = envRect.x + envRect.width + playerWidth/2;
-                player->velocityX = 0;
-                break;
-            }
-        }
-    }
-    player->position.x = newX;
-
-    // 2. Вертикальное перемещение и коллизии (SOLID и JumpThru)
-    float newY = player->position.y + player->speed * delta;
-    Rectangle newPlayerRectY = { player->position.x - playerWidth/2, newY - playerHeight, playerWidth, playerHeight };
-
-    bool onGround = false;
-
-    for (int i = 0; i < envItemsLength; i++)
-    {
-        Rectangle envRect = envItems[i].rect;
-
-        // --- SOLID платформы ---
-        if (envItems[i].type == PLATFORM_SOLID)
-        {
-            if (CheckCollisionRecs(newPlayerRectY, envRect))
-            {
-                if (player->speed > 0)
-                {
-                    newY = envRect.y;
-                    onGround = true;
-                }
-                else if (player->speed < 0)
-                {
-                    newY = envRect.y + envRect.height + playerHeight;
-                }
-                player->speed = 0;
-                break;
-            }
-        }
-        // --- JumpThru платформы ---
-        else if (envItems[i].type == PLATFORM_JUMPTHRU)
-        {
-            float prevBottom = player->position.y;
-            float platTop = envRect.y;
-            float platLeft = envRect.x;
-            float platRight = envRect.x + envRect.width;
-            float playerLeft = player->position.x - playerWidth/2;
-            float playerRight = player->position.x + playerWidth/2;
-
-            // Если dropDown активен — полностью игнорируем платформу
-            if (player->dropDown) {
-                if (prevBottom > platTop + 10.0f) { // Увеличиваем расстояние для сброса dropDown
-                    player->dropDown = false; // Сбросить dropDown после выхода вниз
-                }
-                continue; // Пропускаем все проверки коллизий с этой платформой
-            }
-
-            // Если падаем сверху и НЕ dropDown — обычная посадка на платформу
-            if (player->speed >= 0 &&
-                prevBottom <= platTop + 8.0f && // увеличен допуск по высоте
-                playerRight > platLeft + 2.0f && playerLeft < platRight - 2.0f)
-            {
-                if (CheckCollisionRecs(newPlayerRectY, envRect))
-                {
-                    newY = envRect.y;
-                    onGround = true;
-                    player->speed = 0;
-                    break;
-                }
-            }
-        }
-    }
-    player->position.y = newY;
-
-    // --- Проверка приземления для пыли ---
-    *justLanded = (!wasOnGround && onGround);
-    if (*justLanded) {
-        *landPos = player->position;
-        *justLandedSuperJump = player->superJumpWasInAir;
-        player->superJumpWasInAir = false;
-    } else {
-        *justLandedSuperJump = false;
-    }
-    wasOnGround = onGround;
-    player->canJump = onGround;
+    PlayerInput input = { 0 };
+    input.left = IsKeyDown(KEY_LEFT);
+    input.right = IsKeyDown(KEY_RIGHT);
+    input.down = IsKeyDown(KEY_DOWN);
+    input.jumpPressed = IsKeyPressed(KEY_SPACE);
+    input.jumpDown = IsKeyDown(KEY_SPACE);
+    input.dashPressed = IsKeyPressed(KEY_LEFT_SHIFT) || IsKeyPressed(KEY_RIGHT_SHIFT);
+    return input;
 }
 
 // --- Заглушки для функций камеры ---
@@ -0,0 +1,122 @@
+#include <stdio.h> // Для вывода результатов
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+/*******************************************************************************************
+*
+*   dyntree_bench - нагрузочный тест динамического дерева без окна
+*
+*   Раскладывает N качающихся платформ так же, как нагрузочный тест в игре (клавиша B),
+*   и двигает их через MoveDynTreeProxy заданное число тиков. Для каждого N печатает
+*   среднее время обновления за тик, перестановки листьев за тик, время запроса
+*   прямоугольником размера игрока и высоту дерева.
+*
+*   Запуск: dyntree_bench [--ticks 1440] [количество ...]   (по умолчанию 1000 3000 10000)
+*
+********************************************************************************************/
+
+#include "raylib.h" // Rectangle, Vector2
+#define PLATFORM_BVH_IMPLEMENTATION
+#define PLATFORM_DYNTREE_IMPLEMENTATION
+#include "platform_dyntree.h" // Динамическое дерево
+#include "tool_timer.h" // NowSeconds
+
+#define BENCH_DEFAULT_TICKS 1440      // 10 сек при 144 FPS
+#define BENCH_TICK (1.0f/144.0f)      // Длительность тика
+#define BENCH_COLUMNS 60              // Платформ в ряду (как в игре)
+#define BENCH_MAX_RESULTS 1024        // Максимум результатов запроса
+#define BENCH_PLATFORM_TYPE 2         // PLATFORM_JUMPTHRU, как у платформ нагрузочного теста
+
+// --- Качающаяся платформа (раскладка и движение как у AddStressPlatforms) ---
+typedef struct BenchPlatform {
+    Rectangle rect;     // Текущий прямоугольник
+    Vector2 origin;     // Начальное положение
+    Vector2 amplitude;  // Амплитуда качания
+    float period;       // Период (сек)
+    float phase;        // Сдвиг фазы (доля периода)
+    int proxy;          // Лист в дереве
+} BenchPlatform;
+
+// --- Один прогон: count платформ, ticks тиков ---
+static void RunBenchmark(int count, int ticks)
+{
+    BenchPlatform *platforms = (BenchPlatform *)malloc(count*sizeof(BenchPlatform));
+    DynTree tree = LoadDynTree(2*count);
+    for (int i = 0; i < count; i++) {
+        BenchPlatform *p = &platforms[i];
+        p->rect = (Rectangle){ 1200.0f + (i%BENCH_COLUMNS)*60.0f, -200.0f - (i/BENCH_COLUMNS)*40.0f, 40.0f, 8.0f };
+        p->origin = (Vector2){ p->rect.x, p->rect.y };
+        p->amplitude = (Vector2){ (i%3 == 0) ? 25.0f : 0.0f, (i%3 == 0) ? 0.0f : 15.0f };
+        p->period = 2.0f + (i%7)*0.5f;
+        p->phase = (i%11)/11.0f;
+        p->proxy = CreateDynTreeProxy(&tree, BvhAabbFromRec(p->rect), BVH_TYPE_BIT(BENCH_PLATFORM_TYPE), i);
+    }
+
+    // Обновление: те же действия, что UpdateDynamicPlatforms для MOTION_PATH
+    long long reinserts = 0;
+    double updateSeconds = 0.0;
+    double time = 0.0; // Как dynamicPlatformsTime в игре
+    for (int t = 0; t < ticks; t++) {
+        time += BENCH_TICK;
+        tree.reinsertCount = 0;
+        double start = NowSeconds();
+        for (int i = 0; i < count; i++) {
+            BenchPlatform *p = &platforms[i];
+            double cycles = time/p->period + p->phase;
+            float angle = 2.0f*PI*(float)(cycles - floor(cycles));
+            Vector2 delta = { p->origin.x + p->amplitude.x*sinf(angle) - p->rect.x, p->origin.y + p->amplitude.y*sinf(angle) - p->rect.y };
+            p->rect.x += delta.x;
+            p->rect.y += delta.y;
+            if (delta.x != 0.0f || delta.y != 0.0f) MoveDynTreeProxy(&tree, p->proxy, BvhAabbFromRec(p->rect), delta);
+        }
+        updateSeconds += NowSeconds() - start;
+        reinserts += tree.reinsertCount;
+    }
+
+    // Запросы прямоугольником игрока по всему полю платформ
+    static int results[BENCH_MAX_RESULTS];
+    int queries = 0;
+    long long hits = 0;
+    int rows = (count + BENCH_COLUMNS - 1)/BENCH_COLUMNS;
+    double start = NowSeconds();
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < BENCH_COLUMNS; c++) {
+            float x = 1200.0f + c*60.0f, y = -200.0f - r*40.0f;
+            hits += QueryDynTreeAabb(&tree, (BvhAabb){ x - 20.0f, y - 40.0f, x + 20.0f, y + 8.0f }, BVH_ALL_TYPES, results, BENCH_MAX_RESULTS);
+            queries++;
+        }
+    }
+    double querySeconds = NowSeconds() - start;
+
+    printf("%8d %12.1f %14.2f %12.3f %10.1f %8d\n", count, updateSeconds/ticks*1000000.0, (double)reinserts/ticks,
+           querySeconds/queries*1000000.0, (double)hits/queries, (tree.root != DYNTREE_NULL) ? tree.nodes[tree.root].height : 0);
+
+    UnloadDynTree(tree);
+    free(platforms);
+}
+
+int main(int argc, char **argv)
+{
+    int ticks = BENCH_DEFAULT_TICKS;
+    int counts[16];
+    int countsLength = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (countsLength < 16 && atoi(argv[i]) > 0) counts[countsLength++] = atoi(argv[i]);
+        else {
+            fprintf(stderr, "Usage: dyntree_bench [--ticks N] [count ...]\n");
+            return 1;
+        }
+    }
+    if (countsLength == 0) {
+        counts[countsLength++] = 1000;
+        counts[countsLength++] = 3000;
+        counts[countsLength++] = 10000;
+    }
+    if (ticks < 1) ticks = 1;
+
+    printf("%d ticks per run\n", ticks);
+    printf("%8s %12s %14s %12s %10s %8s\n", "count", "update us", "reinserts/tick", "query us", "hits", "height");
+    for (int i = 0; i < countsLength; i++) RunBenchmark(counts[i], ticks);
+    return 0;
+}
@@ -0,0 +1,363 @@
+#include <stdio.h> // Для вывода результатов
+#include <stdlib.h>
+#include <stddef.h> // offsetof
+#include <string.h>
+#include <pthread.h> // Потоки для параллельного прогона
+#if !defined(_WIN32)
+    #include <unistd.h> // sysconf: количество ядер
+#endif
+/*******************************************************************************************
+*
+*   physics_sweep - перебор констант физики игрока без окна
+*
+*   Берёт сетку значений PlayerTuning и записанный ввод (файл событий raylib automation,
+*   например automation.rae), прогоняет каждую комбинацию на всех ядрах и пишет CSV
+*   с метриками: высота прыжка, время в воздухе, пройденное расстояние, супер-прыжки.
+*
+*   Пример:
+*       physics_sweep --script automation.rae --param gravity=800:1100:7
+*                     --param jumpSpeed=300,350,400 --out sweep.csv
+*
+********************************************************************************************/
+
+#include "raylib.h" // Типы и коды клавиш raylib
+#define PLATFORM_BVH_IMPLEMENTATION
+#define PLATFORM_DYNTREE_IMPLEMENTATION
+#define PLATFORMER_SIM_IMPLEMENTATION
+#include "platformer_sim.h" // Уровень, игрок и физика
+#include "tool_timer.h"     // NowSeconds
+
+#define MAX_SWEEP_PARAMS 9        // Столько полей в PlayerTuning
+#define MAX_SWEEP_VALUES 256      // Максимум значений одного параметра
+#define MAX_SWEEP_RUNS 10000000   // Максимум комбинаций сетки (результаты держатся в памяти)
+#define MAX_SCRIPT_KEYS 512       // Размер таблицы состояний клавиш
+#define SWEEP_TAIL_TICKS 288      // Тиков после последнего события (2 сек при 144 FPS)
+
+// События raylib automation (см. AutomationEventType в rcore.c)
+#define AUTOMATION_INPUT_KEY_UP 1
+#define AUTOMATION_INPUT_KEY_DOWN 2
+
+// --- Параметр перебора: имя поля PlayerTuning и список значений ---
+typedef struct SweepParam {
+    const char *name;   // Имя поля
+    int field;          // Индекс поля в таблице tuningFields
+    float values[MAX_SWEEP_VALUES]; // Значения
+    int valueCount;     // Количество значений
+} SweepParam;
+
+// --- Метрики одного прогона ---
+typedef struct SweepMetrics {
+    float jumpApex;       // Максимальная высота прыжка над точкой отрыва
+    float airTime;        // Суммарное время в воздухе (сек)
+    float maxAirTime;     // Самый долгий полёт (сек)
+    float distance;       // Смещение по X от старта до конца
+    int superJumps;       // Количество супер-прыжков
+    float superJumpApex;  // Максимальная высота супер-прыжка
+} SweepMetrics;
+
+// --- Общие для всех потоков данные (только чтение) ---
+typedef struct SweepJob {
+    const SweepParam *params;  // Параметры перебора
+    int paramCount;            // Количество параметров
+    const PlayerInput *inputs; // Ввод по тикам
+    int ticks;                 // Количество тиков
+    float delta;               // Шаг симуляции (сек)
+    const PlatformBvh *bvh;    // BVH уровня
+    const DynTree *dynamicTree; // Пустое дерево подвижных платформ
+    int runCount;              // Всего комбинаций
+    int threadCount;           // Количество потоков
+    SweepMetrics *results;     // Результаты по номеру прогона
+} SweepJob;
+
+typedef struct SweepWorker {
+    const SweepJob *job; // Общее задание
+    int first;           // Номер первого прогона потока (далее с шагом threadCount)
+} SweepWorker;
+
+// Таблица полей PlayerTuning, доступных для перебора
+static const struct { const char *name; size_t offset; } tuningFields[MAX_SWEEP_PARAMS] = {
+    { "gravity", offsetof(PlayerTuning, gravity) },
+    { "jumpSpeed", offsetof(PlayerTuning, jumpSpeed) },
+    { "maxSpeed", offsetof(PlayerTuning, maxSpeed) },
+    { "acceleration", offsetof(PlayerTuning, acceleration) },
+    { "deceleration", offsetof(PlayerTuning, deceleration) },
+    { "maxJumpTime", offsetof(PlayerTuning, maxJumpTime) },
+    { "jumpHoldForce", offsetof(PlayerTuning, jumpHoldForce) },
+    { "dashSpeed", offsetof(PlayerTuning, dashSpeed) },
+    { "dashTime", offsetof(PlayerTuning, dashTime) },
+};
+
+// --- Разбор "name=v1,v2,v3" или "name=start:end:count" ---
+static bool ParseSweepParam(const char *text, SweepParam *param)
+{
+    const char *eq = strchr(text, '=');
+    if (eq == NULL) return false;
+
+    param->field = -1;
+    for (int f = 0; f < MAX_SWEEP_PARAMS; f++) {
+        if (strlen(tuningFields[f].name) == (size_t)(eq - text) && strncmp(text, tuningFields[f].name, eq - text) == 0) param->field = f;
+    }
+    if (param->field < 0) return false;
+    param->name = tuningFields[param->field].name;
+
+    float start, end;
+    int count;
+    if (sscanf(eq + 1, "%f:%f:%d", &start, &end, &count) == 3) {
+        if (count < 1 || count > MAX_SWEEP_VALUES) return false;
+        for (int i = 0; i < count; i++) param->values[i] = (count == 1) ? start : start + (end - start)*i/(count - 1);
+        param->valueCount = count;
+        return true;
+    }
+
+    param->valueCount = 0;
+    const char *cursor = eq + 1;
+    while (*cursor && param->valueCount < MAX_SWEEP_VALUES) {
+        char *next;
+        param->values[param->valueCount++] = strtof(cursor, &next);
+        if (next == cursor) return false;
+        cursor = (*next == ',') ? next + 1 : next;
+    }
+    return param->valueCount > 0;
+}
+
+// --- Загрузка ввода из текстового файла событий raylib automation ---
+// Клавиша считается зажатой от события KEY_DOWN до KEY_UP, "нажата" - в первый тик зажатия
+static PlayerInput *LoadScriptInputs(const char *fileName, int *ticks)
+{
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) return NULL;
+
+    // Первый проход: длина записи
+    char line[256];
+    int lastFrame = -1;
+    while (fgets(line, sizeof(line), file)) {
+        int frame, type, key;
+        if (sscanf(line, "e %d %d %d", &frame, &type, &key) == 3 && frame > lastFrame) lastFrame = frame;
+    }
+    if (*ticks <= 0) *ticks = lastFrame + 1 + SWEEP_TAIL_TICKS;
+
+    // Второй проход: состояние клавиш по тикам
+    PlayerInput *inputs = (PlayerInput *)calloc(*ticks, sizeof(PlayerInput));
+    bool down[MAX_SCRIPT_KEYS] = { 0 };
+    bool wasDown[MAX_SCRIPT_KEYS] = { 0 };
+    int tick = 0;
+    rewind(file);
+    bool pending = fgets(line, sizeof(line), file) != NULL;
+    while (tick < *ticks) {
+        // События этого тика
+        while (pending) {
+            int frame, type, key;
+            if (sscanf(line, "e %d %d %d", &frame, &type, &key) == 3) {
+                if (frame > tick) break;
+                if (key >= 0 && key < MAX_SCRIPT_KEYS) {
+                    if (type == AUTOMATION_INPUT_KEY_DOWN) down[key] = true;
+                    else if (type == AUTOMATION_INPUT_KEY_UP) down[key] = false;
+                }
+            }
+            pending = fgets(line, sizeof(line), file) != NULL;
+        }
+
+        PlayerInput *in = &inputs[tick];
+        in->left = down[KEY_LEFT];
+        in->right = down[KEY_RIGHT];
+        in->down = down[KEY_DOWN];
+        in->jumpDown = down[KEY_SPACE];
+        in->jumpPressed = down[KEY_SPACE] && !wasDown[KEY_SPACE];
+        in->dashPressed = (down[KEY_LEFT_SHIFT] && !wasDown[KEY_LEFT_SHIFT]) || (down[KEY_RIGHT_SHIFT] && !wasDown[KEY_RIGHT_SHIFT]);
+        memcpy(wasDown, down, sizeof(down));
+        tick++;
+    }
+
+    fclose(file);
+    return inputs;
+}
+
+// --- Константы для прогона с номером run (смешанная система счисления по параметрам) ---
+static PlayerTuning SweepTuning(const SweepJob *job, int run)
+{
+    PlayerTuning tuning = DefaultPlayerTuning();
+    for (int p = job->paramCount - 1; p >= 0; p--) {
+        const SweepParam *param = &job->params[p];
+        float value = param->values[run%param->valueCount];
+        run /= param->valueCount;
+        *(float *)((char *)&tuning + tuningFields[param->field].offset) = value;
+    }
+    return tuning;
+}
+
+// --- Один прогон: тот же UpdatePlayer, что и в игре ---
+static SweepMetrics SimulateRun(const SweepJob *job, const PlayerTuning *tuning)
+{
+    SweepMetrics metrics = { 0 };
+    Player player = CreatePlayer((Vector2){ 400, 280 });
+    float startX = player.position.x;
+
+    bool landedOnce = false;  // Старт в воздухе не считаем прыжком
+    bool inAir = false;
+    bool superJump = false;
+    float takeoffY = 0.0f, minY = 0.0f, flightTime = 0.0f;
+
+    for (int tick = 0; tick < job->ticks; tick++) {
+        float prevY = player.position.y;
+        bool prevSuperInAir = player.superJumpWasInAir;
+        bool justLanded = false, justLandedSuperJump = false;
+        Vector2 landPos = { 0 };
+        UpdatePlayer(&player, tuning, job->inputs[tick], envItems, job->bvh, NULL, job->dynamicTree, job->delta, &justLanded, &justLandedSuperJump, &landPos);
+
+        if (player.superJumpWasInAir && !prevSuperInAir) { superJump = true; metrics.superJumps++; }
+
+        if (!player.canJump) {
+            if (!inAir) { inAir = true; takeoffY = prevY; minY = prevY; flightTime = 0.0f; }
+            if (player.position.y < minY) minY = player.position.y;
+            flightTime += job->delta;
+        } else if (inAir || !landedOnce) {
+            if (landedOnce) {
+                float apex = takeoffY - minY;
+                if (apex > metrics.jumpApex) metrics.jumpApex = apex;
+                if (superJump && apex > metrics.superJumpApex) metrics.superJumpApex = apex;
+                metrics.airTime += flightTime;
+                if (flightTime > metrics.maxAirTime) metrics.maxAirTime = flightTime;
+            }
+            landedOnce = true;
+            inAir = false;
+            superJump = false;
+        }
+    }
+
+    metrics.distance = player.position.x - startX;
+    return metrics;
+}
+
+static void *SweepThread(void *arg)
+{
+    const SweepWorker *worker = (const SweepWorker *)arg;
+    const SweepJob *job = worker->job;
+    for (int run = worker->first; run < job->runCount; run += job->threadCount) {
+        PlayerTuning tuning = SweepTuning(job, run);
+        job->results[run] = SimulateRun(job, &tuning);
+    }
+    return NULL;
+}
+
+static int CpuCount(void)
+{
+#if defined(_WIN32)
+    const char *env = getenv("NUMBER_OF_PROCESSORS");
+    int count = (env != NULL) ? atoi(env) : 1;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+static void PrintUsage(void)
+{
+    fprintf(stderr, "Usage: physics_sweep [--script file.rae] [--param name=v1,v2,...|name=start:end:count]...\n"
+                    "                     [--ticks N] [--fps N] [--threads N] [--out file.csv]\n"
+                    "Params:");
+    for (int f = 0; f < MAX_SWEEP_PARAMS; f++) fprintf(stderr, " %s", tuningFields[f].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    SweepParam *params = (SweepParam *)calloc(MAX_SWEEP_PARAMS, sizeof(SweepParam));
+    int paramCount = 0;
+    const char *scriptPath = "automation.rae";
+    const char *outPath = NULL;
+    int ticks = 0;
+    int fps = 144; // Как SetTargetFPS в игре
+    int threadCount = CpuCount();
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--param") == 0 && hasValue) {
+            if (paramCount >= MAX_SWEEP_PARAMS || !ParseSweepParam(argv[++i], &params[paramCount])) {
+                fprintf(stderr, "Bad --param: %s\n", argv[i]);
+                PrintUsage();
+                return 1;
+            }
+            paramCount++;
+        }
+        else if (strcmp(argv[i], "--script") == 0 && hasValue) scriptPath = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && hasValue) outPath = argv[++i];
+        else if (strcmp(argv[i], "--ticks") == 0 && hasValue) ticks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fps") == 0 && hasValue) fps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else { PrintUsage(); return 1; }
+    }
+    if (fps <= 0 || threadCount <= 0) { PrintUsage(); return 1; }
+
+    PlayerInput *inputs = LoadScriptInputs(scriptPath, &ticks);
+    if (inputs == NULL) {
+        fprintf(stderr, "Cannot read script: %s\n", scriptPath);
+        return 1;
+    }
+
+    // Размер сетки считается в long long и проверяется после каждого множителя (256^9 не влезает и в него)
+    long long gridSize = 1;
+    for (int p = 0; p < paramCount && gridSize <= MAX_SWEEP_RUNS; p++) gridSize *= params[p].valueCount;
+    if (gridSize > MAX_SWEEP_RUNS) {
+        fprintf(stderr, "Grid too large: more than %d runs\n", MAX_SWEEP_RUNS);
+        free(inputs);
+        free(params);
+        return 1;
+    }
+    int runCount = (int)gridSize;
+    if (threadCount > runCount) threadCount = runCount;
+
+    PlatformBvh bvh = LoadEnvItemsBvh(envItems, envItemsLength);
+    DynTree dynamicTree = LoadDynTree(0); // Подвижных платформ в прогоне нет
+
+    SweepJob job = { 0 };
+    job.params = params;
+    job.paramCount = paramCount;
+    job.inputs = inputs;
+    job.ticks = ticks;
+    job.delta = 1.0f/fps;
+    job.bvh = &bvh;
+    job.dynamicTree = &dynamicTree;
+    job.runCount = runCount;
+    job.threadCount = threadCount;
+    job.results = (SweepMetrics *)calloc(runCount, sizeof(SweepMetrics));
+
+    // Прогоны раздаются потокам через один: номер run, run + threadCount, ...
+    double start = NowSeconds();
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t)*threadCount);
+    SweepWorker *workers = (SweepWorker *)malloc(sizeof(SweepWorker)*threadCount);
+    for (int t = 0; t < threadCount; t++) {
+        workers[t] = (SweepWorker){ &job, t };
+        pthread_create(&threads[t], NULL, SweepThread, &workers[t]);
+    }
+    for (int t = 0; t < threadCount; t++) pthread_join(threads[t], NULL);
+    double elapsed = NowSeconds() - start;
+
+    // Результаты в порядке номеров прогонов - файл не зависит от числа потоков
+    FILE *out = (outPath != NULL) ? fopen(outPath, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Cannot write: %s\n", outPath);
+        return 1;
+    }
+    fprintf(out, "run");
+    for (int f = 0; f < MAX_SWEEP_PARAMS; f++) fprintf(out, ",%s", tuningFields[f].name);
+    fprintf(out, ",jumpApex,airTime,maxAirTime,distance,superJumps,superJumpApex\n");
+    for (int run = 0; run < runCount; run++) {
+        PlayerTuning tuning = SweepTuning(&job, run);
+        const SweepMetrics *m = &job.results[run];
+        fprintf(out, "%d", run);
+        for (int f = 0; f < MAX_SWEEP_PARAMS; f++) fprintf(out, ",%g", *(float *)((char *)&tuning + tuningFields[f].offset));
+        fprintf(out, ",%.2f,%.4f,%.4f,%.2f,%d,%.2f\n", m->jumpApex, m->airTime, m->maxAirTime, m->distance, m->superJumps, m->superJumpApex);
+    }
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "%d runs x %d ticks on %d threads: %.3f s (%.0f runs/s)\n", runCount, ticks, threadCount, elapsed, runCount/elapsed);
+
+    free(threads);
+    free(workers);
+    free(job.results);
+    free(inputs);
+    free(params);
+    UnloadDynTree(dynamicTree);
+    UnloadPlatformBvh(bvh);
+    return 0;
+}
@@ -0,0 +1,358 @@
+/*******************************************************************************************
+*
+*   platform_bvh - статическая BVH (иерархия ограничивающих объёмов) по прямоугольникам уровня
+*
+*   Пакетные запросы: лучи, отрезки, свипы AABB и пересечение с прямоугольником,
+*   с фильтрацией по типу платформы (битовая маска PlatformType).
+*
+*   Использование (как у однофайловых библиотек raylib):
+*       #define PLATFORM_BVH_IMPLEMENTATION
+*       #include "platform_bvh.h"
+*
+********************************************************************************************/
+
+#ifndef PLATFORM_BVH_H
+#define PLATFORM_BVH_H
+
+#include <stdbool.h>
+#include "raylib.h" // Rectangle, Vector2
+
+#define BVH_TYPE_BIT(type) (1u << (unsigned int)(type)) // Бит маски для типа платформы
+#define BVH_ALL_TYPES 0xFFFFFFFFu                        // Маска: любые типы
+#define BVH_MAX_LEAF_SIZE 4                              // Максимум примитивов в листе
+#define BVH_STACK_SIZE 64                                // Глубина стека обхода
+
+// --- Ограничивающий прямоугольник в виде min/max ---
+typedef struct BvhAabb {
+    float minX, minY; // Левый верхний угол
+    float maxX, maxY; // Правый нижний угол
+} BvhAabb;
+
+// --- Узел дерева (плоский массив в порядке обхода в глубину: левый потомок = узел + 1) ---
+typedef struct BvhNode {
+    BvhAabb box;           // Границы узла
+    unsigned int typeMask; // Объединение типов всех примитивов под узлом
+    int offset;            // Лист: первый примитив; внутренний узел: индекс правого потомка
+    int count;             // Лист: количество примитивов; внутренний узел: 0
+} BvhNode;
+
+// --- Дерево ---
+typedef struct PlatformBvh {
+    BvhNode *nodes;           // Узлы
+    int nodeCount;            // Количество узлов
+    BvhAabb *primBoxes;       // Границы примитивов, переупорядоченные под листья
+    unsigned int *primMasks;  // Бит типа каждого примитива (тот же порядок)
+    int *primIndices;         // Исходный индекс примитива (тот же порядок)
+    int primCount;            // Количество примитивов
+} PlatformBvh;
+
+// --- Запросы ---
+typedef struct BvhRay {
+    Vector2 origin;     // Начало луча
+    Vector2 direction;  // Направление (длина задаёт масштаб t)
+    float maxT;         // Максимальный параметр t
+} BvhRay;
+
+typedef struct BvhSegment {
+    Vector2 start;      // Начало отрезка
+    Vector2 end;        // Конец отрезка
+} BvhSegment;
+
+typedef struct BvhSweep {
+    Rectangle box;      // Прямоугольник в начальном положении
+    Vector2 delta;      // Перемещение за запрос
+} BvhSweep;
+
+// --- Результат луча/отрезка/свипа ---
+typedef struct BvhHit {
+    int index;          // Исходный индекс прямоугольника или -1, если попадания нет
+    float t;            // Параметр попадания (для отрезка и свипа — доля пути 0..1)
+    Vector2 point;      // Точка попадания (для свипа — центр прямоугольника в момент касания)
+    Vector2 normal;     // Нормаль грани, в которую попали
+} BvhHit;
+
+PlatformBvh LoadPlatformBvh(const Rectangle *rects, const int *types, int count); // Построить дерево
+void UnloadPlatformBvh(PlatformBvh bvh);                                          // Освободить дерево
+
+BvhAabb BvhAabbFromRec(Rectangle rec); // Rectangle -> min/max
+int QueryPlatformBvhAabb(const PlatformBvh *bvh, BvhAabb box, unsigned int typeMask, int *indices, int maxIndices); // Пересечения по возрастанию индекса (при переполнении - maxIndices наименьших)
+
+void RaycastPlatformBvhBatch(const PlatformBvh *bvh, const BvhRay *rays, int count, unsigned int typeMask, BvhHit *hits);              // Пакет лучей
+void SegmentcastPlatformBvhBatch(const PlatformBvh *bvh, const BvhSegment *segments, int count, unsigned int typeMask, BvhHit *hits);  // Пакет отрезков
+void SweepPlatformBvhBatch(const PlatformBvh *bvh, const BvhSweep *sweeps, int count, unsigned int typeMask, BvhHit *hits);            // Пакет свипов AABB
+
+// Вставка в отсортированный список из не более maxIndices наименьших индексов; возвращает новую длину
+static inline int BvhInsertSmallest(int *indices, int found, int maxIndices, int value)
+{
+    if (maxIndices <= 0) return 0;
+    if (found == maxIndices && value >= indices[found - 1]) return found; // Не входит в наименьшие
+    int j = (found < maxIndices) ? found++ : found - 1; // При переполнении вытесняется наибольший
+    while (j > 0 && indices[j - 1] > value) { indices[j] = indices[j - 1]; j--; }
+    indices[j] = value;
+    return found;
+}
+
+#endif // PLATFORM_BVH_H
+
+/***********************************************************************************
+*
+*   PLATFORM_BVH IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(PLATFORM_BVH_IMPLEMENTATION) && !defined(PLATFORM_BVH_IMPLEMENTED)
+#define PLATFORM_BVH_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+#include <stdlib.h>
+#include <math.h>
+
+// --- Вспомогательные функции построения ---
+static BvhAabb BvhAabbUnion(BvhAabb a, BvhAabb b)
+{
+    BvhAabb r;
+    r.minX = (a.minX < b.minX) ? a.minX : b.minX;
+    r.minY = (a.minY < b.minY) ? a.minY : b.minY;
+    r.maxX = (a.maxX > b.maxX) ? a.maxX : b.maxX;
+    r.maxY = (a.maxY > b.maxY) ? a.maxY : b.maxY;
+    return r;
+}
+
+static float BvhCentroid(BvhAabb b, int axis)
+{
+    return (axis == 0) ? (b.minX + b.maxX)*0.5f : (b.minY + b.maxY)*0.5f;
+}
+
+static void BvhSwapPrims(PlatformBvh *bvh, int a, int b)
+{
+    BvhAabb tb = bvh->primBoxes[a]; bvh->primBoxes[a] = bvh->primBoxes[b]; bvh->primBoxes[b] = tb;
+    unsigned int tm = bvh->primMasks[a]; bvh->primMasks[a] = bvh->primMasks[b]; bvh->primMasks[b] = tm;
+    int ti = bvh->primIndices[a]; bvh->primIndices[a] = bvh->primIndices[b]; bvh->primIndices[b] = ti;
+}
+
+// Quickselect: ставит k-й по центру элемент на место k, меньшие слева, большие справа
+static void BvhSelect(PlatformBvh *bvh, int lo, int hi, int k, int axis)
+{
+    while (hi > lo) {
+        float pivot = BvhCentroid(bvh->primBoxes[(lo + hi)/2], axis);
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (BvhCentroid(bvh->primBoxes[i], axis) < pivot) i++;
+            while (BvhCentroid(bvh->primBoxes[j], axis) > pivot) j--;
+            if (i <= j) { BvhSwapPrims(bvh, i, j); i++; j--; }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return;
+    }
+}
+
+// Рекурсивное построение: узлы пишутся в порядке обхода в глубину
+static int BvhBuildRange(PlatformBvh *bvh, int first, int count)
+{
+    int nodeIndex = bvh->nodeCount++;
+    BvhNode *node = &bvh->nodes[nodeIndex];
+    node->box = bvh->primBoxes[first];
+    node->typeMask = 0;
+    BvhAabb centroids = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+    for (int i = first; i < first + count; i++) {
+        node->box = BvhAabbUnion(node->box, bvh->primBoxes[i]);
+        node->typeMask |= bvh->primMasks[i];
+        float cx = BvhCentroid(bvh->primBoxes[i], 0);
+        float cy = BvhCentroid(bvh->primBoxes[i], 1);
+        centroids = BvhAabbUnion(centroids, (BvhAabb){ cx, cy, cx, cy });
+    }
+
+    if (count <= BVH_MAX_LEAF_SIZE) {
+        node->offset = first;
+        node->count = count;
+        return nodeIndex;
+    }
+
+    // Делим по медиане центров вдоль самой длинной оси - дерево сбалансировано
+    int axis = ((centroids.maxX - centroids.minX) >= (centroids.maxY - centroids.minY)) ? 0 : 1;
+    int half = count/2;
+    BvhSelect(bvh, first, first + count - 1, first + half, axis);
+
+    node->count = 0;
+    BvhBuildRange(bvh, first, half);
+    int right = BvhBuildRange(bvh, first + half, count - half);
+    bvh->nodes[nodeIndex].offset = right; // node мог устареть - пишем по индексу
+    return nodeIndex;
+}
+
+BvhAabb BvhAabbFromRec(Rectangle rec)
+{
+    return (BvhAabb){ rec.x, rec.y, rec.x + rec.width, rec.y + rec.height };
+}
+
+// --- Построение дерева ---
+PlatformBvh LoadPlatformBvh(const Rectangle *rects, const int *types, int count)
+{
+    PlatformBvh bvh = { 0 };
+    if (count <= 0) return bvh;
+
+    bvh.primCount = count;
+    bvh.primBoxes = (BvhAabb *)malloc(sizeof(BvhAabb)*count);
+    bvh.primMasks = (unsigned int *)malloc(sizeof(unsigned int)*count);
+    bvh.primIndices = (int *)malloc(sizeof(int)*count);
+    bvh.nodes = (BvhNode *)malloc(sizeof(BvhNode)*(2*count - 1));
+    for (int i = 0; i < count; i++) {
+        bvh.primBoxes[i] = BvhAabbFromRec(rects[i]);
+        bvh.primMasks[i] = BVH_TYPE_BIT(types[i]);
+        bvh.primIndices[i] = i;
+    }
+    BvhBuildRange(&bvh, 0, count);
+    return bvh;
+}
+
+void UnloadPlatformBvh(PlatformBvh bvh)
+{
+    free(bvh.nodes);
+    free(bvh.primBoxes);
+    free(bvh.primMasks);
+    free(bvh.primIndices);
+}
+
+// --- Пересечение с прямоугольником (строгое, как в CheckCollisionRecs) ---
+static bool BvhAabbOverlap(BvhAabb a, BvhAabb b)
+{
+    return (a.minX < b.maxX) && (a.maxX > b.minX) && (a.minY < b.maxY) && (a.maxY > b.minY);
+}
+
+int QueryPlatformBvhAabb(const PlatformBvh *bvh, BvhAabb box, unsigned int typeMask, int *indices, int maxIndices)
+{
+    if (bvh->nodeCount == 0) return 0;
+
+    int found = 0;
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const BvhNode *node = &bvh->nodes[stack[--top]];
+        if (!(node->typeMask & typeMask) || !BvhAabbOverlap(node->box, box)) continue;
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                if ((bvh->primMasks[i] & typeMask) && BvhAabbOverlap(bvh->primBoxes[i], box))
+                    found = BvhInsertSmallest(indices, found, maxIndices, bvh->primIndices[i]);
+            }
+        } else {
+            stack[top++] = node->offset;
+            stack[top++] = (int)(node - bvh->nodes) + 1;
+        }
+    }
+
+    // Список уже отсортирован: вызывающий код обходит кандидатов в порядке исходного массива,
+    // а при переполнении теряются только самые поздние из них
+    return found;
+}
+
+// --- Луч против расширенного на halfW/halfH прямоугольника (метод слэбов) ---
+// Возвращает true, если [tEnter, tExit] пересекает [0, maxT]; axis - ось входа (-1: старт внутри по обеим)
+static bool BvhSlab(BvhAabb b, Vector2 o, Vector2 d, Vector2 inv, float halfW, float halfH, float maxT, float *tEnter, int *axis)
+{
+    float tMin = -INFINITY, tMax = INFINITY;
+    *axis = -1;
+    if (d.x == 0.0f) {
+        if (o.x < b.minX - halfW || o.x > b.maxX + halfW) return false;
+    } else {
+        float t1 = (b.minX - halfW - o.x)*inv.x;
+        float t2 = (b.maxX + halfW - o.x)*inv.x;
+        if (t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+        tMin = t1; tMax = t2; *axis = 0;
+    }
+    if (d.y == 0.0f) {
+        if (o.y < b.minY - halfH || o.y > b.maxY + halfH) return false;
+    } else {
+        float t1 = (b.minY - halfH - o.y)*inv.y;
+        float t2 = (b.maxY + halfH - o.y)*inv.y;
+        if (t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+        if (t1 > tMin) { tMin = t1; *axis = 1; }
+        if (t2 < tMax) tMax = t2;
+    }
+    *tEnter = tMin;
+    return (tMin <= tMax) && (tMax >= 0.0f) && (tMin <= maxT);
+}
+
+// Общий обход для луча (halfW = halfH = 0) и свипа прямоугольника.
+// Попадание засчитывается только при входе в прямоугольник (t >= 0): стартующий внутри луч его не видит.
+static BvhHit BvhCast(const PlatformBvh *bvh, Vector2 o, Vector2 d, float maxT, float halfW, float halfH, unsigned int typeMask)
+{
+    BvhHit hit = { -1, maxT, { 0 }, { 0 } };
+    if (bvh->nodeCount == 0) return hit;
+
+    Vector2 inv = { (d.x != 0.0f) ? 1.0f/d.x : 0.0f, (d.y != 0.0f) ? 1.0f/d.y : 0.0f };
+    int hitAxis = -1;
+    float tEnter;
+    int axis;
+
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        int nodeIndex = stack[--top];
+        const BvhNode *node = &bvh->nodes[nodeIndex];
+        if (!(node->typeMask & typeMask)) continue;
+        if (!BvhSlab(node->box, o, d, inv, halfW, halfH, hit.t, &tEnter, &axis)) continue;
+
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                if (!(bvh->primMasks[i] & typeMask)) continue;
+                if (!BvhSlab(bvh->primBoxes[i], o, d, inv, halfW, halfH, hit.t, &tEnter, &axis)) continue;
+                if (tEnter < 0.0f || axis < 0) continue;
+                // При равном t выигрывает меньший исходный индекс - результат не зависит от формы дерева
+                if (tEnter < hit.t || hit.index < 0 || (tEnter == hit.t && bvh->primIndices[i] < hit.index)) {
+                    hit.t = tEnter;
+                    hit.index = bvh->primIndices[i];
+                    hitAxis = axis;
+                }
+            }
+        } else {
+            // Сначала обходим ближнего потомка: кладём его в стек последним
+            int left = nodeIndex + 1, right = node->offset;
+            float tLeft = INFINITY, tRight = INFINITY;
+            bool hitLeft = BvhSlab(bvh->nodes[left].box, o, d, inv, halfW, halfH, hit.t, &tLeft, &axis);
+            bool hitRight = BvhSlab(bvh->nodes[right].box, o, d, inv, halfW, halfH, hit.t, &tRight, &axis);
+            if (hitLeft && hitRight) {
+                if (tLeft <= tRight) { stack[top++] = right; stack[top++] = left; }
+                else { stack[top++] = left; stack[top++] = right; }
+            }
+            else if (hitLeft) stack[top++] = left;
+            else if (hitRight) stack[top++] = right;
+        }
+    }
+
+    if (hit.index >= 0) {
+        hit.point = (Vector2){ o.x + d.x*hit.t, o.y + d.y*hit.t };
+        if (hitAxis == 0) hit.normal = (Vector2){ (d.x > 0.0f) ? -1.0f : 1.0f, 0.0f };
+        else hit.normal = (Vector2){ 0.0f, (d.y > 0.0f) ? -1.0f : 1.0f };
+    }
+    return hit;
+}
+
+// --- Пакетные запросы: дерево остаётся горячим в кэше на весь пакет ---
+void RaycastPlatformBvhBatch(const PlatformBvh *bvh, const BvhRay *rays, int count, unsigned int typeMask, BvhHit *hits)
+{
+    for (int i = 0; i < count; i++)
+        hits[i] = BvhCast(bvh, rays[i].origin, rays[i].direction, rays[i].maxT, 0.0f, 0.0f, typeMask);
+}
+
+void SegmentcastPlatformBvhBatch(const PlatformBvh *bvh, const BvhSegment *segments, int count, unsigned int typeMask, BvhHit *hits)
+{
+    for (int i = 0; i < count; i++) {
+        Vector2 d = { segments[i].end.x - segments[i].start.x, segments[i].end.y - segments[i].start.y };
+        hits[i] = BvhCast(bvh, segments[i].start, d, 1.0f, 0.0f, 0.0f, typeMask);
+    }
+}
+
+void SweepPlatformBvhBatch(const PlatformBvh *bvh, const BvhSweep *sweeps, int count, unsigned int typeMask, BvhHit *hits)
+{
+    for (int i = 0; i < count; i++) {
+        // Свип прямоугольника = луч из его центра против прямоугольников, расширенных на половину размера
+        float halfW = sweeps[i].box.width*0.5f;
+        float halfH = sweeps[i].box.height*0.5f;
+        Vector2 center = { sweeps[i].box.x + halfW, sweeps[i].box.y + halfH };
+        hits[i] = BvhCast(bvh, center, sweeps[i].delta, 1.0f, halfW, halfH, typeMask);
+    }
+}
+
+#endif // PLATFORM_BVH_IMPLEMENTATION
@@ -0,0 +1,327 @@
+/*******************************************************************************************
+*
+*   platform_dyntree - динамическое AABB-дерево для подвижных платформ
+*
+*   Каждый объект хранится в листе с "толстым" прямоугольником (запас + упреждение по
+*   смещению). Пока объект остаётся внутри своего толстого прямоугольника, дерево не
+*   меняется; при выходе за него переставляется только этот лист. Балансировка -
+*   повороты как в AVL-дереве.
+*
+*   Использование:
+*       #define PLATFORM_DYNTREE_IMPLEMENTATION
+*       #include "platform_dyntree.h"
+*
+********************************************************************************************/
+
+#ifndef PLATFORM_DYNTREE_H
+#define PLATFORM_DYNTREE_H
+
+#include <stdbool.h>
+#include "platform_bvh.h" // BvhAabb, BVH_TYPE_BIT
+
+#define DYNTREE_NULL -1                     // Нет узла
+#define DYNTREE_MARGIN 4.0f                 // Запас толстого прямоугольника (пиксели)
+#define DYNTREE_DISPLACEMENT_MULTIPLIER 4.0f // Упреждение по смещению за тик
+#define DYNTREE_STACK_SIZE 256              // Глубина стека обхода на стеке вызова (глубже - в куче)
+
+// --- Узел дерева ---
+typedef struct DynTreeNode {
+    BvhAabb box;           // Лист: толстый прямоугольник; внутренний узел: объединение потомков
+    unsigned int typeMask; // Объединение типов всех листьев под узлом
+    int parent;            // Родитель (в свободном узле - следующий свободный)
+    int child1, child2;    // Потомки (у листа DYNTREE_NULL)
+    int height;            // Лист: 0; свободный узел: -1
+    int userIndex;         // Индекс объекта пользователя (только у листа)
+} DynTreeNode;
+
+// --- Дерево ---
+typedef struct DynTree {
+    DynTreeNode *nodes;    // Пул узлов
+    int capacity;          // Размер пула
+    int nodeCount;         // Занятых узлов
+    int root;              // Корень
+    int freeList;          // Голова списка свободных узлов
+    int reinsertCount;     // Сколько листьев переставлено (статистика, сбрасывает пользователь)
+} DynTree;
+
+DynTree LoadDynTree(int capacity); // Создать дерево с заранее выделенным пулом
+void UnloadDynTree(DynTree tree);  // Освободить дерево
+
+int CreateDynTreeProxy(DynTree *tree, BvhAabb box, unsigned int typeMask, int userIndex); // Добавить объект, вернуть id листа
+void DestroyDynTreeProxy(DynTree *tree, int proxy);                                      // Удалить объект
+bool MoveDynTreeProxy(DynTree *tree, int proxy, BvhAabb box, Vector2 displacement);      // Сдвинуть объект; true, если лист переставлен
+
+int QueryDynTreeAabb(const DynTree *tree, BvhAabb box, unsigned int typeMask, int *userIndices, int maxIndices); // Пересечения с толстыми прямоугольниками (по возрастанию; при переполнении - maxIndices наименьших)
+
+#endif // PLATFORM_DYNTREE_H
+
+/***********************************************************************************
+*
+*   PLATFORM_DYNTREE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(PLATFORM_DYNTREE_IMPLEMENTATION) && !defined(PLATFORM_DYNTREE_IMPLEMENTED)
+#define PLATFORM_DYNTREE_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+#include <stdlib.h>
+
+static BvhAabb DynTreeUnion(BvhAabb a, BvhAabb b)
+{
+    BvhAabb r;
+    r.minX = (a.minX < b.minX) ? a.minX : b.minX;
+    r.minY = (a.minY < b.minY) ? a.minY : b.minY;
+    r.maxX = (a.maxX > b.maxX) ? a.maxX : b.maxX;
+    r.maxY = (a.maxY > b.maxY) ? a.maxY : b.maxY;
+    return r;
+}
+
+static float DynTreePerimeter(BvhAabb a)
+{
+    return 2.0f*((a.maxX - a.minX) + (a.maxY - a.minY));
+}
+
+static bool DynTreeContains(BvhAabb outer, BvhAabb inner)
+{
+    return (outer.minX <= inner.minX) && (outer.minY <= inner.minY) && (outer.maxX >= inner.maxX) && (outer.maxY >= inner.maxY);
+}
+
+// --- Пул узлов ---
+static void DynTreeGrow(DynTree *tree, int capacity)
+{
+    int old = tree->capacity;
+    tree->nodes = (DynTreeNode *)realloc(tree->nodes, sizeof(DynTreeNode)*capacity);
+    tree->capacity = capacity;
+    for (int i = old; i < capacity; i++) {
+        tree->nodes[i].parent = (i + 1 < capacity) ? i + 1 : tree->freeList;
+        tree->nodes[i].height = -1;
+    }
+    tree->freeList = old;
+}
+
+static int DynTreeAllocNode(DynTree *tree)
+{
+    if (tree->freeList == DYNTREE_NULL) DynTreeGrow(tree, (tree->capacity > 0) ? tree->capacity*2 : 16);
+    int id = tree->freeList;
+    DynTreeNode *node = &tree->nodes[id];
+    tree->freeList = node->parent;
+    node->parent = node->child1 = node->child2 = DYNTREE_NULL;
+    node->height = 0;
+    node->typeMask = 0;
+    node->userIndex = -1;
+    tree->nodeCount++;
+    return id;
+}
+
+static void DynTreeFreeNode(DynTree *tree, int id)
+{
+    tree->nodes[id].parent = tree->freeList;
+    tree->nodes[id].height = -1;
+    tree->freeList = id;
+    tree->nodeCount--;
+}
+
+// Пересчёт границ, высоты и маски внутреннего узла по потомкам
+static void DynTreeRefit(DynTree *tree, int id)
+{
+    DynTreeNode *n = &tree->nodes[id];
+    const DynTreeNode *a = &tree->nodes[n->child1];
+    const DynTreeNode *b = &tree->nodes[n->child2];
+    n->box = DynTreeUnion(a->box, b->box);
+    n->height = 1 + ((a->height > b->height) ? a->height : b->height);
+    n->typeMask = a->typeMask | b->typeMask;
+}
+
+static void DynTreeReplaceChild(DynTree *tree, int parent, int oldChild, int newChild)
+{
+    if (parent == DYNTREE_NULL) tree->root = newChild;
+    else if (tree->nodes[parent].child1 == oldChild) tree->nodes[parent].child1 = newChild;
+    else tree->nodes[parent].child2 = newChild;
+}
+
+// Поворот вокруг узла iA, если высоты потомков различаются больше чем на 1. Возвращает новый корень поддерева
+static int DynTreeBalance(DynTree *tree, int iA)
+{
+    DynTreeNode *A = &tree->nodes[iA];
+    if (A->child1 == DYNTREE_NULL || A->height < 2) return iA;
+
+    int iB = A->child1, iC = A->child2;
+    int balance = tree->nodes[iC].height - tree->nodes[iB].height;
+
+    if (balance > 1 || balance < -1) {
+        // Поднимаем более высокого потомка (iUp), его более низкий внук уходит к A
+        int iUp = (balance > 1) ? iC : iB;
+        DynTreeNode *up = &tree->nodes[iUp];
+        int iF = up->child1, iG = up->child2;
+        int iTall = (tree->nodes[iF].height > tree->nodes[iG].height) ? iF : iG;
+        int iShort = (iTall == iF) ? iG : iF;
+
+        up->child1 = iA;
+        up->child2 = iTall;
+        up->parent = A->parent;
+        A->parent = iUp;
+        DynTreeReplaceChild(tree, up->parent, iA, iUp);
+
+        if (balance > 1) A->child2 = iShort;
+        else A->child1 = iShort;
+        tree->nodes[iShort].parent = iA;
+
+        DynTreeRefit(tree, iA);
+        DynTreeRefit(tree, iUp);
+        return iUp;
+    }
+    return iA;
+}
+
+// Подъём от узла к корню с балансировкой и пересчётом границ
+static void DynTreeFixUpwards(DynTree *tree, int index)
+{
+    while (index != DYNTREE_NULL) {
+        DynTreeRefit(tree, index);
+        index = DynTreeBalance(tree, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+static void DynTreeInsertLeaf(DynTree *tree, int leaf)
+{
+    if (tree->root == DYNTREE_NULL) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = DYNTREE_NULL;
+        return;
+    }
+
+    // Поиск соседа: спуск по минимальной стоимости (периметр как эвристика площади)
+    BvhAabb leafBox = tree->nodes[leaf].box;
+    int index = tree->root;
+    while (tree->nodes[index].child1 != DYNTREE_NULL) {
+        const DynTreeNode *n = &tree->nodes[index];
+        float area = DynTreePerimeter(n->box);
+        float combined = DynTreePerimeter(DynTreeUnion(n->box, leafBox));
+        float cost = 2.0f*combined;
+        float inheritance = 2.0f*(combined - area);
+
+        float childCost[2];
+        int children[2] = { n->child1, n->child2 };
+        for (int c = 0; c < 2; c++) {
+            const DynTreeNode *child = &tree->nodes[children[c]];
+            float grown = DynTreePerimeter(DynTreeUnion(leafBox, child->box));
+            childCost[c] = (child->child1 == DYNTREE_NULL) ? grown + inheritance : grown - DynTreePerimeter(child->box) + inheritance;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = (childCost[0] < childCost[1]) ? children[0] : children[1];
+    }
+    int sibling = index;
+
+    // Новый родитель для листа и соседа (пул может переехать - работаем только через индексы)
+    int newParent = DynTreeAllocNode(tree);
+    int oldParent = tree->nodes[sibling].parent;
+    tree->nodes[newParent].parent = oldParent;
+    tree->nodes[newParent].child1 = sibling;
+    tree->nodes[newParent].child2 = leaf;
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+    DynTreeReplaceChild(tree, oldParent, sibling, newParent);
+
+    DynTreeFixUpwards(tree, newParent);
+}
+
+static void DynTreeRemoveLeaf(DynTree *tree, int leaf)
+{
+    if (leaf == tree->root) {
+        tree->root = DYNTREE_NULL;
+        return;
+    }
+
+    int parent = tree->nodes[leaf].parent;
+    int grandParent = tree->nodes[parent].parent;
+    int sibling = (tree->nodes[parent].child1 == leaf) ? tree->nodes[parent].child2 : tree->nodes[parent].child1;
+
+    DynTreeReplaceChild(tree, grandParent, parent, sibling);
+    tree->nodes[sibling].parent = grandParent;
+    DynTreeFreeNode(tree, parent);
+
+    DynTreeFixUpwards(tree, grandParent);
+}
+
+// --- Публичный интерфейс ---
+DynTree LoadDynTree(int capacity)
+{
+    DynTree tree = { 0 };
+    tree.root = DYNTREE_NULL;
+    tree.freeList = DYNTREE_NULL;
+    if (capacity > 0) DynTreeGrow(&tree, capacity);
+    return tree;
+}
+
+void UnloadDynTree(DynTree tree)
+{
+    free(tree.nodes);
+}
+
+int CreateDynTreeProxy(DynTree *tree, BvhAabb box, unsigned int typeMask, int userIndex)
+{
+    int proxy = DynTreeAllocNode(tree);
+    DynTreeNode *node = &tree->nodes[proxy];
+    node->box = (BvhAabb){ box.minX - DYNTREE_MARGIN, box.minY - DYNTREE_MARGIN, box.maxX + DYNTREE_MARGIN, box.maxY + DYNTREE_MARGIN };
+    node->typeMask = typeMask;
+    node->userIndex = userIndex;
+    DynTreeInsertLeaf(tree, proxy);
+    return proxy;
+}
+
+void DestroyDynTreeProxy(DynTree *tree, int proxy)
+{
+    DynTreeRemoveLeaf(tree, proxy);
+    DynTreeFreeNode(tree, proxy);
+}
+
+bool MoveDynTreeProxy(DynTree *tree, int proxy, BvhAabb box, Vector2 displacement)
+{
+    // Всё ещё внутри толстого прямоугольника - дерево не трогаем
+    if (DynTreeContains(tree->nodes[proxy].box, box)) return false;
+
+    DynTreeRemoveLeaf(tree, proxy);
+
+    // Новый толстый прямоугольник: запас + упреждение в сторону движения
+    BvhAabb fat = { box.minX - DYNTREE_MARGIN, box.minY - DYNTREE_MARGIN, box.maxX + DYNTREE_MARGIN, box.maxY + DYNTREE_MARGIN };
+    Vector2 d = { displacement.x*DYNTREE_DISPLACEMENT_MULTIPLIER, displacement.y*DYNTREE_DISPLACEMENT_MULTIPLIER };
+    if (d.x < 0.0f) fat.minX += d.x; else fat.maxX += d.x;
+    if (d.y < 0.0f) fat.minY += d.y; else fat.maxY += d.y;
+    tree->nodes[proxy].box = fat;
+
+    DynTreeInsertLeaf(tree, proxy);
+    tree->reinsertCount++;
+    return true;
+}
+
+int QueryDynTreeAabb(const DynTree *tree, BvhAabb box, unsigned int typeMask, int *userIndices, int maxIndices)
+{
+    if (tree->root == DYNTREE_NULL) return 0;
+
+    // Обход в глубину держит в стеке не больше height + 1 узлов; для вырожденного дерева - стек в куче
+    int found = 0;
+    int localStack[DYNTREE_STACK_SIZE];
+    int stackSize = tree->nodes[tree->root].height + 1;
+    int *stack = (stackSize <= DYNTREE_STACK_SIZE) ? localStack : (int *)malloc(sizeof(int)*stackSize);
+    int top = 0;
+    stack[top++] = tree->root;
+    while (top > 0) {
+        const DynTreeNode *node = &tree->nodes[stack[--top]];
+        if (!(node->typeMask & typeMask)) continue;
+        if (!((node->box.minX < box.maxX) && (node->box.maxX > box.minX) && (node->box.minY < box.maxY) && (node->box.maxY > box.minY))) continue;
+        if (node->child1 == DYNTREE_NULL) {
+            found = BvhInsertSmallest(userIndices, found, maxIndices, node->userIndex);
+        } else {
+            stack[top++] = node->child1;
+            stack[top++] = node->child2;
+        }
+    }
+    if (stack != localStack) free(stack);
+
+    // Порядок как у исходного массива объектов; при переполнении остаются наименьшие индексы
+    return found;
+}
+
+#endif // PLATFORM_DYNTREE_IMPLEMENTATION
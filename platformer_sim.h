@@ -0,0 +1,480 @@
+/*******************************************************************************************
+*
+*   platformer_sim - симуляция игрока без окна и клавиатуры
+*
+*   Типы уровня и игрока, настраиваемые во время выполнения константы (PlayerTuning)
+*   и UpdatePlayer, который читает ввод из PlayerInput. Используется игрой и
+*   консольными утилитами (например, physics_sweep).
+*
+*   Использование:
+*       #define PLATFORM_BVH_IMPLEMENTATION
+*       #define PLATFORM_DYNTREE_IMPLEMENTATION
+*       #define PLATFORMER_SIM_IMPLEMENTATION
+*       #include "platformer_sim.h"
+*
+********************************************************************************************/
+
+#ifndef PLATFORMER_SIM_H
+#define PLATFORMER_SIM_H
+
+#include <stdbool.h>
+#include "raylib.h"           // Vector2, Rectangle, Color
+#include "platform_bvh.h"     // Статическая BVH уровня
+#include "platform_dyntree.h" // Дерево подвижных платформ
+
+// --- Константы игрока (значения PlayerTuning по умолчанию) ---
+#define G 950 // Гравитация
+#define PLAYER_JUMP_SPD 350.0f // Скорость прыжка игрока
+#define PLAYER_MAX_SPEED 500.0f // Максимальная горизонтальная скорость игрока
+#define PLAYER_ACCELERATION 400.0f // Ускорение игрока
+#define PLAYER_DECELERATION 450.0f // Замедление игрока
+#define PLAYER_MAX_JUMP_TIME 0.40f // Максимальное время удержания прыжка
+#define PLAYER_JUMP_HOLD_FORCE 500.0f // Сила удержания прыжка
+#define PLAYER_DASH_SPEED 900.0f // Скорость рывка
+#define PLAYER_DASH_TIME 0.18f   // Длительность рывка (сек)
+
+// --- Настраиваемые константы игрока ---
+typedef struct PlayerTuning {
+    float gravity;       // Гравитация
+    float jumpSpeed;     // Скорость прыжка
+    float maxSpeed;      // Максимальная горизонтальная скорость
+    float acceleration;  // Ускорение
+    float deceleration;  // Замедление
+    float maxJumpTime;   // Максимальное время удержания прыжка
+    float jumpHoldForce; // Сила удержания прыжка
+    float dashSpeed;     // Скорость рывка
+    float dashTime;      // Длительность рывка (сек)
+} PlayerTuning;
+
+// --- Ввод игрока за один тик ---
+typedef struct PlayerInput {
+    bool left;         // Влево зажато
+    bool right;        // Вправо зажато
+    bool down;         // Вниз зажато
+    bool jumpPressed;  // Прыжок нажат в этом тике
+    bool jumpDown;     // Прыжок зажат
+    bool dashPressed;  // Рывок нажат в этом тике
+} PlayerInput;
+
+// --- Типы платформ ---
+typedef enum { PLATFORM_NONE = 0, PLATFORM_SOLID = 1, PLATFORM_JUMPTHRU = 2 } PlatformType; // Типы платформ
+
+// --- Структура игрока ---
+typedef struct Player {
+    Vector2 position;   // Центр ног игрока
+    float speed;        // Вертикальная скорость
+    float velocityX;    // Горизонтальная скорость
+    bool canJump;       // Может прыгать
+    float jumpTime;     // Время удержания прыжка
+    bool isJumping;     // Сейчас прыгает
+    bool dropDown;      // Флаг: инициировано спрыгивание с JumpThru
+    int dropPlatform;   // JumpThru, с которой спрыгиваем (индекс уровня или подвижной платформы)
+    bool dropDynamic;   // dropPlatform - индекс подвижной платформы
+    int jumpCount;      // Счетчик прыжков для распрыжки
+    bool dashing;       // Сейчас выполняется рывок
+    float dashTime;     // Оставшееся время рывка
+    bool isSuperJump;   // Флаг супер-прыжка
+    bool wasSuperJump;  // Флаг: был ли последний прыжок супер-прыжком
+    int lastDirection;  // Последнее направление движения: 1 — вправо, -1 — влево
+    bool superJumpWasInAir; // Был ли в воздухе после супер-прыжка
+    int groundPlatform; // Индекс подвижной платформы под ногами (-1 — нет)
+    bool wasOnGround;   // Стоял ли на земле в прошлом тике
+    int collisionCandidates; // Кандидатов на коллизию за последний тик (статистика)
+} Player;
+
+// --- Структура платформы ---
+typedef struct EnvItem {
+    Rectangle rect;     // Прямоугольник платформы
+    PlatformType type;  // Тип платформы
+    Color color;        // Цвет платформы
+} EnvItem;
+
+typedef enum { MOTION_PATH = 0, MOTION_FALLING = 1, MOTION_CRUMBLING = 2 } PlatformMotion; // Виды движения
+
+typedef struct DynamicPlatform {
+    EnvItem item;          // Прямоугольник, тип коллизии и цвет
+    PlatformMotion motion; // Вид движения
+    Vector2 origin;        // Начальное положение (левый верхний угол)
+    Vector2 amplitude;     // MOTION_PATH: амплитуда качания по X и Y
+    float period;          // MOTION_PATH: период качания (сек)
+    float phase;           // MOTION_PATH: сдвиг фазы (доля периода)
+    float timer;           // Время с момента срабатывания или исчезновения
+    float fallSpeed;       // MOTION_FALLING: текущая скорость падения
+    bool triggered;        // Игрок наступил на платформу
+    bool active;           // Платформа существует (разрушенная ждёт возрождения)
+    Vector2 delta;         // Смещение за последний тик
+    int proxy;             // Лист в динамическом дереве (DYNTREE_NULL, если неактивна)
+} DynamicPlatform;
+
+// --- BVH по платформам уровня (строится один раз при старте) ---
+#define MAX_COLLISION_CANDIDATES 64 // Максимум кандидатов на коллизию за один запрос
+
+extern EnvItem envItems[];  // Уровень
+extern int envItemsLength;  // Количество платформ уровня
+
+PlayerTuning DefaultPlayerTuning(void);  // Константы по умолчанию
+Player CreatePlayer(Vector2 position);   // Игрок в начальном состоянии
+PlatformBvh LoadEnvItemsBvh(EnvItem *envItems, int envItemsLength); // Построение BVH по платформам
+int GatherCollisionCandidates(EnvItem *envItems, const PlatformBvh *bvh, DynamicPlatform *dynamicPlatforms, const DynTree *dynamicTree, BvhAabb box, unsigned int typeMask, EnvItem **items, int *dynamicIndices, int maxCandidates); // Кандидаты на коллизию
+void UpdatePlayer(Player *player, const PlayerTuning *tuning, PlayerInput input, EnvItem *envItems, const PlatformBvh *bvh, DynamicPlatform *dynamicPlatforms, const DynTree *dynamicTree, float delta, bool *justLanded, bool *justLandedSuperJump, Vector2 *landPos); // Обновление состояния игрока
+
+#endif // PLATFORMER_SIM_H
+
+/***********************************************************************************
+*
+*   PLATFORMER_SIM IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(PLATFORMER_SIM_IMPLEMENTATION) && !defined(PLATFORMER_SIM_IMPLEMENTED)
+#define PLATFORMER_SIM_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+#include <stdlib.h>
+#include <math.h>
+
+// --- Уровень: добавлен JumpThru справа от оранжевой платформы ---
+EnvItem envItems[] = {
+        {{ 0, 0,  1000,   400 },      PLATFORM_NONE,    LIGHTGRAY }, // Фон
+        {{ 0, 400, 5000, 200 }, PLATFORM_SOLID, GRAY },             // Земля
+        {{ 0, -10, 50, 2000 }, PLATFORM_SOLID, GRAY },              // Левая стена
+        {{ 300, 200, 400, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
+        {{ 250, 300, 100, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
+        {{ 650, 300, 100, 10 }, PLATFORM_SOLID, GRAY },             // Платформа
+        {{ 800, 300, 100, 20 }, PLATFORM_SOLID, ORANGE },           // Оранжевая платформа
+        {{ 950, 320, 120, 10 }, PLATFORM_JUMPTHRU, VIOLET }         // JumpThru-платформа
+};
+int envItemsLength = sizeof(envItems)/sizeof(envItems[0]); // Количество платформ
+
+PlayerTuning DefaultPlayerTuning(void)
+{
+    PlayerTuning tuning = { 0 };
+    tuning.gravity = G;
+    tuning.jumpSpeed = PLAYER_JUMP_SPD;
+    tuning.maxSpeed = PLAYER_MAX_SPEED;
+    tuning.acceleration = PLAYER_ACCELERATION;
+    tuning.deceleration = PLAYER_DECELERATION;
+    tuning.maxJumpTime = PLAYER_MAX_JUMP_TIME;
+    tuning.jumpHoldForce = PLAYER_JUMP_HOLD_FORCE;
+    tuning.dashSpeed = PLAYER_DASH_SPEED;
+    tuning.dashTime = PLAYER_DASH_TIME;
+    return tuning;
+}
+
+Player CreatePlayer(Vector2 position)
+{
+    Player player = {0}; // Создание структуры игрока и обнуление
+    player.position = position; // Начальная позиция игрока
+    player.speed = 0; // Начальная вертикальная скорость
+    player.velocityX = 0; // Начальная горизонтальная скорость
+    player.canJump = false; // Может ли прыгать
+    player.jumpTime = 0.0f; // Время удержания прыжка
+    player.isJumping = false; // Прыгает ли сейчас
+    player.dropDown = false; // Флаг спрыгивания с JumpThru
+    player.dropPlatform = -1; // Не спрыгивает ни с какой платформы
+    player.dropDynamic = false;
+    player.jumpCount = 0; // Счетчик прыжков для распрыжки
+    player.dashing = false; // Не в рывке
+    player.dashTime = 0.0f; // Таймер рывка
+    player.isSuperJump = false; // Флаг супер-прыжка
+    player.wasSuperJump = false; // Флаг: был ли последний прыжок супер-прыжком
+    player.lastDirection = 1; // По умолчанию смотрит вправо
+    player.superJumpWasInAir = false;
+    player.groundPlatform = -1; // Не стоит на подвижной платформе
+    player.wasOnGround = false; // В первом тике ещё не на земле
+    return player;
+}
+
+// Построение BVH по массиву платформ
+PlatformBvh LoadEnvItemsBvh(EnvItem *envItems, int envItemsLength)
+{
+    Rectangle *rects = malloc(sizeof(Rectangle)*envItemsLength);
+    int *types = malloc(sizeof(int)*envItemsLength);
+    for (int i = 0; i < envItemsLength; i++) {
+        rects[i] = envItems[i].rect;
+        types[i] = envItems[i].type;
+    }
+    PlatformBvh bvh = LoadPlatformBvh(rects, types, envItemsLength);
+    free(rects);
+    free(types);
+    return bvh;
+}
+
+// Сбор кандидатов на коллизию: сначала статические (по индексу), затем подвижные (по индексу)
+int GatherCollisionCandidates(EnvItem *envItems, const PlatformBvh *bvh, DynamicPlatform *dynamicPlatforms, const DynTree *dynamicTree, BvhAabb box, unsigned int typeMask, EnvItem **items, int *dynamicIndices, int maxCandidates)
+{
+    int indices[MAX_COLLISION_CANDIDATES];
+    int count = QueryPlatformBvhAabb(bvh, box, typeMask, indices, maxCandidates);
+    for (int c = 0; c < count; c++) {
+        items[c] = &envItems[indices[c]];
+        dynamicIndices[c] = -1;
+    }
+    int dynamicCount = QueryDynTreeAabb(dynamicTree, box, typeMask, indices, maxCandidates - count);
+    for (int c = 0; c < dynamicCount; c++) {
+        items[count + c] = &dynamicPlatforms[indices[c]].item;
+        dynamicIndices[count + c] = indices[c];
+    }
+    return count + dynamicCount;
+}
+
+// --- Игрок с поддержкой JumpThru платформ и drop-down ---
+void UpdatePlayer(Player *player, const PlayerTuning *tuning, PlayerInput input, EnvItem *envItems, const PlatformBvh *bvh, DynamicPlatform *dynamicPlatforms, const DynTree *dynamicTree, float delta, bool *justLanded, bool *justLandedSuperJump, Vector2 *landPos)
+{
+    // --- Спрыгивание с JumpThru: если стоим и нажали вниз+пробел, активируем dropDown и НЕ прыгаем! ---
+    if (input.down && input.jumpPressed)
+    {
+        // Запоминаем JumpThru под ногами; если её нет, спрыгивать не с чего
+        player->dropPlatform = -1;
+        player->dropDynamic = false;
+        if (player->groundPlatform >= 0 && dynamicPlatforms[player->groundPlatform].item.type == PLATFORM_JUMPTHRU) {
+            player->dropPlatform = player->groundPlatform;
+            player->dropDynamic = true;
+        } else {
+            BvhAabb feet = { player->position.x - 18.0f, player->position.y - 1.0f, player->position.x + 18.0f, player->position.y + 1.0f }; // Ширина игрока без допуска посадки
+            int index;
+            if (QueryPlatformBvhAabb(bvh, feet, BVH_TYPE_BIT(PLATFORM_JUMPTHRU), &index, 1) > 0) player->dropPlatform = index;
+        }
+        player->dropDown = (player->dropPlatform >= 0);
+        player->isJumping = false; // Отключаем прыжок!
+        player->jumpTime = 0.0f;
+        player->canJump = false;
+        player->speed = 200.0f; // Даем значительную скорость вниз для проваливания
+    }
+
+    // --- Подвижная платформа под ногами переносит игрока на своё смещение за тик ---
+    Vector2 carry = { 0.0f, 0.0f };
+    Vector2 inherited = { 0.0f, 0.0f }; // Скорость платформы, полученная при прыжке в этом тике
+    if (player->groundPlatform >= 0) {
+        const DynamicPlatform *ground = &dynamicPlatforms[player->groundPlatform];
+        if (ground->active) carry = ground->delta;
+        else player->groundPlatform = -1;
+    }
+
+    // Запоминаем последнее направление ВСЕГДА
+    if (input.left && !input.right) player->lastDirection = -1;
+    if (input.right && !input.left) player->lastDirection = 1;
+
+    if (!player->dashing && (input.dashPressed)) {
+        // Рывок только если есть движение влево или вправо
+        if (input.left) {
+            player->dashing = true;
+            player->dashTime = tuning->dashTime;
+            player->velocityX = -tuning->dashSpeed;
+            player->lastDirection = -1;
+        } else if (input.right) {
+            player->dashing = true;
+            player->dashTime = tuning->dashTime;
+            player->velocityX = tuning->dashSpeed;
+            player->lastDirection = 1;
+        }
+    }
+    if (player->dashing) {
+        player->dashTime -= delta;
+        // Во время рывка игнорируем обычное управление (кроме гравитации и коллизий)
+        if (player->dashTime <= 0.0f) {
+            player->dashing = false;
+            // После рывка скорость сбрасывается к обычной максимальной, если была выше
+            if (player->velocityX > tuning->maxSpeed) player->velocityX = tuning->maxSpeed;
+            if (player->velocityX < -tuning->maxSpeed) player->velocityX = -tuning->maxSpeed;
+        }
+    } else {
+        // --- Горизонтальное движение ---
+        float targetSpeed = 0.0f;
+        if (input.left) targetSpeed -= tuning->maxSpeed;
+        if (input.right) targetSpeed += tuning->maxSpeed;
+
+        if (targetSpeed != 0)
+        {
+            if (player->velocityX < targetSpeed)
+            {
+                player->velocityX += tuning->acceleration * delta;
+                if (player->velocityX > targetSpeed) player->velocityX = targetSpeed;
+            }
+            else if (player->velocityX > targetSpeed)
+            {
+                player->velocityX -= tuning->acceleration * delta;
+                if (player->velocityX < targetSpeed) player->velocityX = targetSpeed;
+            }
+        }
+        else
+        {
+            if (player->velocityX > 0)
+            {
+                player->velocityX -= tuning->deceleration * delta;
+                if (player->velocityX < 0) player->velocityX = 0;
+            }
+            else if (player->velocityX < 0)
+            {
+                player->velocityX += tuning->deceleration * delta;
+                if (player->velocityX > 0) player->velocityX = 0;
+            }
+        }
+    }
+
+    // Сброс счетчика прыжков, если персонаж остановился
+    if (player->velocityX == 0) {
+        player->jumpCount = 0;
+    }
+
+    // --- Прыжок с контролем по времени удержания ---
+    if (input.jumpPressed && player->canJump && !player->dropDown)
+    {
+        float jumpSpeed = -tuning->jumpSpeed;
+        if (fabs(player->velocityX) >= tuning->maxSpeed) {
+            player->jumpCount++;
+            if (player->jumpCount == 3) {
+                jumpSpeed *= 2.0f; // В 2 раза выше
+                player->jumpCount = 0; // Сбросить счетчик
+                player->isSuperJump = true; // Устанавливаем флаг супер-прыжка
+                player->superJumpWasInAir = true; // Запоминаем, что был супер-прыжок
+            }
+        } else {
+            player->jumpCount = 0; // Если прыжок не на максимальной скорости, сбрасываем счетчик
+            player->isSuperJump = false;
+        }
+        player->speed = jumpSpeed;
+        // Прыжок с подвижной платформы сохраняет её скорость (вниз не тянет)
+        if (delta > 0.0f) {
+            inherited.x = carry.x/delta;
+            inherited.y = (carry.y < 0.0f) ? carry.y/delta : 0.0f;
+            player->velocityX += inherited.x;
+            player->speed += inherited.y;
+        }
+        player->canJump = false;
+        player->isJumping = true;
+        player->jumpTime = 0.0f;
+    }
+
+    if (input.jumpDown && player->isJumping && player->jumpTime < tuning->maxJumpTime)
+    {
+        player->speed -= tuning->jumpHoldForce * delta;
+        player->jumpTime += delta;
+    }
+    else
+    {
+        player->isJumping = false;
+    }
+
+    // --- Гравитация ---
+    player->speed += tuning->gravity * delta;
+
+    // --- Размеры игрока ---
+    float playerWidth = 40.0f;
+    float playerHeight = 40.0f;
+
+    // --- Сначала движение по X, потом по Y ---
+    // 1. Горизонтальное перемещение и коллизии
+    // В тике прыжка смещение платформы уже учтено переносом, унаследованная скорость действует со следующего
+    float moveX = (player->velocityX - inherited.x) * delta + carry.x;
+    float newX = player->position.x + moveX;
+    Rectangle newPlayerRectX = { newX - playerWidth/2, player->position.y + carry.y - playerHeight, playerWidth, playerHeight }; // По высоте уже перенесён платформой
+
+    // Кандидаты приходят по возрастанию индекса — порядок обхода как у полного перебора
+    EnvItem *candidates[MAX_COLLISION_CANDIDATES];
+    int candidateDynamic[MAX_COLLISION_CANDIDATES];
+    int candidateCount = GatherCollisionCandidates(envItems, bvh, dynamicPlatforms, dynamicTree, BvhAabbFromRec(newPlayerRectX), BVH_TYPE_BIT(PLATFORM_SOLID), candidates, candidateDynamic, MAX_COLLISION_CANDIDATES);
+    player->collisionCandidates = candidateCount;
+
+    for (int c = 0; c < candidateCount; c++)
+    {
+        Rectangle envRect = candidates[c]->rect;
+        if (CheckCollisionRecs(newPlayerRectX, envRect))
+        {
+            if (moveX > 0)
+                newX = envRect.x - playerWidth/2;
+            else if (moveX < 0)
+                newX = envRect.x + envRect.width + playerWidth/2;
+            player->velocityX = 0;
+            break;
+        }
+    }
+    player->position.x = newX;
+
+    // 2. Вертикальное перемещение и коллизии (SOLID и JumpThru)
+    // Ноги до собственного движения за тик (с учётом переноса платформой)
+    float prevBottom = player->position.y + carry.y;
+    float newY = prevBottom + (player->speed - inherited.y) * delta;
+    Rectangle newPlayerRectY = { player->position.x - playerWidth/2, newY - playerHeight, playerWidth, playerHeight };
+
+    bool onGround = false;
+    int landedPlatform = -1; // Подвижная платформа, на которую приземлились
+
+    // Сброс dropDown: ноги опустились на 10 пикселей ниже верха той JumpThru, с которой спрыгнули
+    // (платформы выше и ниже неё не в счёт; исчезнувшая подвижная платформа сбрасывает сразу)
+    if (player->dropDown) {
+        bool dropGone = player->dropDynamic && !dynamicPlatforms[player->dropPlatform].active;
+        const EnvItem *dropItem = player->dropDynamic ? &dynamicPlatforms[player->dropPlatform].item : &envItems[player->dropPlatform];
+        if (dropGone || prevBottom > dropItem->rect.y + 10.0f) player->dropDown = false;
+    }
+
+    candidateCount = GatherCollisionCandidates(envItems, bvh, dynamicPlatforms, dynamicTree, BvhAabbFromRec(newPlayerRectY), BVH_TYPE_BIT(PLATFORM_SOLID) | BVH_TYPE_BIT(PLATFORM_JUMPTHRU), candidates, candidateDynamic, MAX_COLLISION_CANDIDATES);
+    player->collisionCandidates += candidateCount;
+
+    for (int c = 0; c < candidateCount; c++)
+    {
+        Rectangle envRect = candidates[c]->rect;
+
+        // --- SOLID платформы ---
+        if (candidates[c]->type == PLATFORM_SOLID)
+        {
+            if (CheckCollisionRecs(newPlayerRectY, envRect))
+            {
+                if (player->speed > 0)
+                {
+                    newY = envRect.y;
+                    onGround = true;
+                    landedPlatform = candidateDynamic[c];
+                }
+                else if (player->speed < 0)
+                {
+                    newY = envRect.y + envRect.height + playerHeight;
+                }
+                player->speed = 0;
+                break;
+            }
+        }
+        // --- JumpThru платформы ---
+        else if (candidates[c]->type == PLATFORM_JUMPTHRU)
+        {
+            float platTop = envRect.y;
+            float platLeft = envRect.x;
+            float platRight = envRect.x + envRect.width;
+            float playerLeft = player->position.x - playerWidth/2;
+            float playerRight = player->position.x + playerWidth/2;
+
+            // Если dropDown активен — полностью игнорируем платформу
+            if (player->dropDown) continue;
+
+            // Если падаем сверху и НЕ dropDown — обычная посадка на платформу
+            if (player->speed >= 0 &&
+                prevBottom <= platTop + 8.0f && // увеличен допуск по высоте
+                playerRight > platLeft + 2.0f && playerLeft < platRight - 2.0f)
+            {
+                if (CheckCollisionRecs(newPlayerRectY, envRect))
+                {
+                    newY = envRect.y;
+                    onGround = true;
+                    landedPlatform = candidateDynamic[c];
+                    player->speed = 0;
+                    break;
+                }
+            }
+        }
+    }
+    player->position.y = newY;
+
+    // --- Проверка приземления для пыли ---
+    *justLanded = (!player->wasOnGround && onGround);
+    if (*justLanded) {
+        *landPos = player->position;
+        *justLandedSuperJump = player->superJumpWasInAir;
+        player->superJumpWasInAir = false;
+    } else {
+        *justLandedSuperJump = false;
+    }
+    if (onGround) player->dropDown = false; // Приземлились на SOLID раньше, чем прошли JumpThru
+    player->wasOnGround = onGround;
+    player->canJump = onGround;
+    player->groundPlatform = landedPlatform;
+}
+
+#endif // PLATFORMER_SIM_IMPLEMENTATION
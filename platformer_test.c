@@ -0,0 +1,131 @@
+#include <stdio.h> // Для вывода результатов
+#include <stdlib.h>
+/*******************************************************************************************
+*
+*   platformer_test - проверка спрыгивания с JumpThru без окна
+*
+*   Прогоняет UpdatePlayer на маленьких уровнях:
+*       - столбик JumpThru через 40 пикселей, как ряды нагрузочного теста (клавиша B):
+*         вниз+пробел на любом ряду проваливает игрока ровно на ряд ниже, и статические,
+*         и подвижные платформы;
+*       - вниз+пробел на земле без JumpThru под ногами не оставляет dropDown, и
+*         следующий прыжок срабатывает.
+*
+*   Запуск: platformer_test
+*   Код возврата: 0 - все проверки прошли, 1 - есть расхождения
+*
+********************************************************************************************/
+
+#include "raylib.h" // Rectangle, Vector2, цвета
+#define PLATFORM_BVH_IMPLEMENTATION
+#define PLATFORM_DYNTREE_IMPLEMENTATION
+#define PLATFORMER_SIM_IMPLEMENTATION
+#include "platformer_sim.h" // Проверяемая симуляция
+
+#define TEST_TICK (1.0f/144.0f)     // Длительность тика
+#define TEST_ROWS 4                 // Рядов JumpThru в столбике
+#define TEST_ROW_TOP 160.0f         // Верхний ряд
+#define TEST_ROW_STEP 40.0f         // Шаг рядов, как в нагрузочном тесте
+#define TEST_COLUMN_X 1200.0f       // Левый край столбика
+#define TEST_SETTLE_TICKS 72        // Тиков на приземление и на спрыгивание (0.5 сек)
+
+// --- Маленький уровень: статические платформы и подвижные в дереве ---
+typedef struct TestLevel {
+    EnvItem items[1 + TEST_ROWS];               // Земля и (по выбору) статический столбик
+    int itemsLength;
+    PlatformBvh bvh;
+    DynamicPlatform dynamic[TEST_ROWS];         // Подвижный столбик (стоит на месте)
+    DynTree tree;
+} TestLevel;
+
+static TestLevel LoadTestLevel(bool dynamicRows)
+{
+    TestLevel level = { 0 };
+    level.items[level.itemsLength++] = (EnvItem){ { 0, 400, 5000, 200 }, PLATFORM_SOLID, GRAY }; // Земля
+    level.tree = LoadDynTree(2*TEST_ROWS);
+    for (int r = 0; r < TEST_ROWS; r++) {
+        EnvItem row = { { TEST_COLUMN_X, TEST_ROW_TOP + r*TEST_ROW_STEP, 40.0f, 8.0f }, PLATFORM_JUMPTHRU, SKYBLUE };
+        if (!dynamicRows) {
+            level.items[level.itemsLength++] = row;
+            continue;
+        }
+        DynamicPlatform *p = &level.dynamic[r];
+        p->item = row;
+        p->origin = (Vector2){ row.rect.x, row.rect.y };
+        p->active = true;
+        p->proxy = CreateDynTreeProxy(&level.tree, BvhAabbFromRec(row.rect), BVH_TYPE_BIT(PLATFORM_JUMPTHRU), r);
+    }
+    level.bvh = LoadEnvItemsBvh(level.items, level.itemsLength);
+    return level;
+}
+
+static void UnloadTestLevel(TestLevel *level)
+{
+    UnloadPlatformBvh(level->bvh);
+    UnloadDynTree(level->tree);
+}
+
+// Прогон ticks тиков с одним и тем же вводом
+static void RunTicks(TestLevel *level, Player *player, PlayerInput input, int ticks)
+{
+    PlayerTuning tuning = DefaultPlayerTuning();
+    for (int t = 0; t < ticks; t++) {
+        bool justLanded, justLandedSuperJump;
+        Vector2 landPos;
+        UpdatePlayer(player, &tuning, input, level->items, &level->bvh, level->dynamic, &level->tree, TEST_TICK, &justLanded, &justLandedSuperJump, &landPos);
+        input.jumpPressed = false; // Нажатие только в первом тике
+        input.dashPressed = false;
+    }
+}
+
+static bool Check(const char *name, bool passed)
+{
+    printf("  %-52s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+// Игрок стоит на ряду row, нажимает вниз+пробел и должен встать на ряд row + 1 (нижний - на землю)
+static bool CheckRowDrop(bool dynamicRows, int row)
+{
+    TestLevel level = LoadTestLevel(dynamicRows);
+    Player player = CreatePlayer((Vector2){ TEST_COLUMN_X + 20.0f, TEST_ROW_TOP + row*TEST_ROW_STEP - 1.0f });
+    RunTicks(&level, &player, (PlayerInput){ 0 }, TEST_SETTLE_TICKS);
+    float standY = player.position.y;
+    RunTicks(&level, &player, (PlayerInput){ .down = true, .jumpPressed = true }, 1);
+    RunTicks(&level, &player, (PlayerInput){ 0 }, TEST_SETTLE_TICKS);
+    float expectedY = (row + 1 < TEST_ROWS) ? TEST_ROW_TOP + (row + 1)*TEST_ROW_STEP : 400.0f;
+    bool passed = (standY == TEST_ROW_TOP + row*TEST_ROW_STEP) && (player.position.y == expectedY) && player.canJump && !player.dropDown;
+    if (!passed) printf("    stood at %.1f, ended at %.1f (expected %.1f), dropDown %d\n", standY, player.position.y, expectedY, player.dropDown);
+    UnloadTestLevel(&level);
+    return passed;
+}
+
+// Вниз+пробел на земле без JumpThru под ногами: dropDown не остаётся, прыжок после этого работает
+static bool CheckGroundDrop(void)
+{
+    TestLevel level = LoadTestLevel(false);
+    Player player = CreatePlayer((Vector2){ 150.0f, 399.0f });
+    RunTicks(&level, &player, (PlayerInput){ 0 }, TEST_SETTLE_TICKS);
+    RunTicks(&level, &player, (PlayerInput){ .down = true, .jumpPressed = true }, 1);
+    bool cleared = !player.dropDown;
+    RunTicks(&level, &player, (PlayerInput){ 0 }, TEST_SETTLE_TICKS);
+    RunTicks(&level, &player, (PlayerInput){ .jumpPressed = true, .jumpDown = true }, 10);
+    bool jumped = (player.position.y < 400.0f - 10.0f);
+    if (!cleared || !jumped) printf("    dropDown after press %d, y after jump %.1f\n", !cleared, player.position.y);
+    UnloadTestLevel(&level);
+    return cleared && jumped;
+}
+
+int main(void)
+{
+    bool passed = true;
+    char name[64];
+    for (int dynamicRows = 0; dynamicRows <= 1; dynamicRows++) {
+        for (int row = 0; row < TEST_ROWS; row++) {
+            snprintf(name, sizeof(name), "%s JumpThru row %d drops to the next row", dynamicRows ? "dynamic" : "static", row);
+            passed &= Check(name, CheckRowDrop(dynamicRows, row));
+        }
+    }
+    passed &= Check("down+jump on the ground leaves jumping intact", CheckGroundDrop());
+    return passed ? 0 : 1;
+}
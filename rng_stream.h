@@ -0,0 +1,162 @@
+/*******************************************************************************************
+*
+*   rng_stream - воспроизводимые потоки случайных чисел на Philox4x32-10
+*
+*   Генератор со счётчиком: блок из четырёх чисел - чистая функция от (seed, номер потока,
+*   номер блока). Поэтому у каждой подсистемы свой поток, результат не зависит от порядка
+*   вызовов в других подсистемах, а пакетное заполнение не имеет зависимостей между
+*   итерациями и векторизуется/делится между потоками без изменения результата.
+*
+*   Использование:
+*       #define RNG_STREAM_IMPLEMENTATION
+*       #include "rng_stream.h"
+*
+********************************************************************************************/
+
+#ifndef RNG_STREAM_H
+#define RNG_STREAM_H
+
+#include <stdint.h>
+
+// --- Поток случайных чисел ---
+typedef struct RngStream {
+    uint32_t key[2];      // Ключ Philox (из seed)
+    uint32_t streamId;    // Номер потока (подсистемы)
+    uint64_t counter;     // Номер следующего блока
+    uint32_t buffer[4];   // Текущий блок для поштучной выдачи
+    int bufferIndex;      // Следующее число в буфере (4 - буфер пуст)
+} RngStream;
+
+RngStream CreateRngStream(uint64_t seed, uint32_t streamId); // Поток подсистемы streamId
+void RngPhilox(const RngStream *stream, uint64_t block, uint32_t out[4]); // Блок с номером block (без изменения потока)
+
+uint32_t RngNextU32(RngStream *stream);                  // Следующее 32-битное число
+int RngNextInt(RngStream *stream, int min, int max);     // Целое в [min, max], как GetRandomValue
+float RngNextFloat(RngStream *stream);                   // Вещественное в [0, 1)
+
+// Пакетное заполнение: начинается с нового блока, остаток поштучного буфера отбрасывается
+void RngFillInts(RngStream *stream, int *out, int count, int min, int max);         // Целые в [min, max]
+void RngFillFloats(RngStream *stream, float *out, int count, float min, float max); // Вещественные в [min, max)
+
+#endif // RNG_STREAM_H
+
+/***********************************************************************************
+*
+*   RNG_STREAM IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RNG_STREAM_IMPLEMENTATION) && !defined(RNG_STREAM_IMPLEMENTED)
+#define RNG_STREAM_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+// Константы Philox4x32 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+#define RNG_PHILOX_M0 0xD2511F53u
+#define RNG_PHILOX_M1 0xCD9E8D57u
+#define RNG_PHILOX_W0 0x9E3779B9u
+#define RNG_PHILOX_W1 0xBB67AE85u
+#define RNG_PHILOX_ROUNDS 10
+
+RngStream CreateRngStream(uint64_t seed, uint32_t streamId)
+{
+    RngStream stream = { 0 };
+    stream.key[0] = (uint32_t)seed;
+    stream.key[1] = (uint32_t)(seed >> 32);
+    stream.streamId = streamId;
+    stream.bufferIndex = 4;
+    return stream;
+}
+
+// Счётчик блока: {номер блока (64 бита), номер потока, 0}
+void RngPhilox(const RngStream *stream, uint64_t block, uint32_t out[4])
+{
+    uint32_t c0 = (uint32_t)block, c1 = (uint32_t)(block >> 32), c2 = stream->streamId, c3 = 0;
+    uint32_t k0 = stream->key[0], k1 = stream->key[1];
+    for (int round = 0; round < RNG_PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)RNG_PHILOX_M0*c0;
+        uint64_t p1 = (uint64_t)RNG_PHILOX_M1*c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += RNG_PHILOX_W0;
+        k1 += RNG_PHILOX_W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// --- Отображение 32-битного числа в диапазон ---
+static inline int RngToInt(uint32_t x, int min, uint32_t range)
+{
+    // range == 0 означает полный 32-битный диапазон
+    return (range == 0) ? (int)((uint32_t)min + x) : (int)((uint32_t)min + (uint32_t)(((uint64_t)x*range) >> 32));
+}
+
+static inline float RngToFloat(uint32_t x)
+{
+    return (x >> 8)*(1.0f/16777216.0f); // 24 старших бита -> [0, 1)
+}
+
+// --- Поштучная выдача ---
+uint32_t RngNextU32(RngStream *stream)
+{
+    if (stream->bufferIndex >= 4) {
+        RngPhilox(stream, stream->counter++, stream->buffer);
+        stream->bufferIndex = 0;
+    }
+    return stream->buffer[stream->bufferIndex++];
+}
+
+int RngNextInt(RngStream *stream, int min, int max)
+{
+    if (min > max) { int t = min; min = max; max = t; }
+    return RngToInt(RngNextU32(stream), min, (uint32_t)max - (uint32_t)min + 1u);
+}
+
+float RngNextFloat(RngStream *stream)
+{
+    return RngToFloat(RngNextU32(stream));
+}
+
+// --- Пакетное заполнение: итерации независимы, блок i зависит только от counter + i ---
+void RngFillInts(RngStream *stream, int *out, int count, int min, int max)
+{
+    if (min > max) { int t = min; min = max; max = t; }
+    uint32_t range = (uint32_t)max - (uint32_t)min + 1u;
+    uint64_t base = stream->counter;
+    int fullBlocks = count/4;
+    for (int b = 0; b < fullBlocks; b++) {
+        uint32_t r[4];
+        RngPhilox(stream, base + b, r);
+        for (int j = 0; j < 4; j++) out[b*4 + j] = RngToInt(r[j], min, range);
+    }
+    if (count%4 != 0) {
+        uint32_t r[4];
+        RngPhilox(stream, base + fullBlocks, r);
+        for (int j = 0; j < count%4; j++) out[fullBlocks*4 + j] = RngToInt(r[j], min, range);
+    }
+    stream->counter = base + (count + 3)/4;
+    stream->bufferIndex = 4;
+}
+
+void RngFillFloats(RngStream *stream, float *out, int count, float min, float max)
+{
+    float scale = max - min;
+    uint64_t base = stream->counter;
+    int fullBlocks = count/4;
+    for (int b = 0; b < fullBlocks; b++) {
+        uint32_t r[4];
+        RngPhilox(stream, base + b, r);
+        for (int j = 0; j < 4; j++) out[b*4 + j] = min + scale*RngToFloat(r[j]);
+    }
+    if (count%4 != 0) {
+        uint32_t r[4];
+        RngPhilox(stream, base + fullBlocks, r);
+        for (int j = 0; j < count%4; j++) out[fullBlocks*4 + j] = min + scale*RngToFloat(r[j]);
+    }
+    stream->counter = base + (count + 3)/4;
+    stream->bufferIndex = 4;
+}
+
+#endif // RNG_STREAM_IMPLEMENTATION
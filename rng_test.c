@@ -0,0 +1,137 @@
+#include <stdio.h> // Для вывода результатов
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h> // Проверка независимости от числа потоков
+/*******************************************************************************************
+*
+*   rng_test - проверка потоков rng_stream и сравнение с GetRandomValue
+*
+*   Проверки:
+*       - эталонный вектор Philox4x32-10 (Random123, счётчик и ключ нулевые);
+*       - пакетное заполнение совпадает с поштучной выдачей;
+*       - RngFillInts, разделённый между N потоками (N = 1..8), даёт тот же массив,
+*         что и один вызов: каждый поток берёт свою часть блоков по номеру блока.
+*   Замер: миллионы чисел в секунду для цикла GetRandomValue, RngNextInt и RngFillInts.
+*
+*   Запуск: rng_test [--count 4000000]
+*   Код возврата: 0 - все проверки прошли, 1 - есть расхождения
+*
+********************************************************************************************/
+
+#include "raylib.h" // GetRandomValue - текущий путь, с которым сравниваем
+#define RNG_STREAM_IMPLEMENTATION
+#include "rng_stream.h" // Проверяемые потоки
+#include "tool_timer.h" // NowSeconds
+
+#define TEST_SEED 0x5EEDF00Dull     // Seed для проверок
+#define TEST_MAX_THREADS 8          // Проверяем 1..8 потоков
+#define TEST_MIN -30                // Диапазон как у разброса пыли по X
+#define TEST_MAX 30
+
+// --- Часть пакета для одного потока ---
+typedef struct FillJob {
+    RngStream stream;   // Копия потока, переставленная на первый блок части
+    int *out;           // Начало части в общем массиве
+    int count;          // Чисел в части
+} FillJob;
+
+static void *FillThread(void *arg)
+{
+    FillJob *job = (FillJob *)arg;
+    RngFillInts(&job->stream, job->out, job->count, TEST_MIN, TEST_MAX);
+    return NULL;
+}
+
+// Заполнение count чисел в threadCount потоков; границы частей кратны блоку из 4 чисел
+static void ParallelFill(const RngStream *stream, int *out, int count, int threadCount)
+{
+    pthread_t threads[TEST_MAX_THREADS];
+    FillJob jobs[TEST_MAX_THREADS];
+    int blocks = (count + 3)/4;
+    for (int t = 0; t < threadCount; t++) {
+        int firstBlock = (int)((long long)blocks*t/threadCount);
+        int lastBlock = (int)((long long)blocks*(t + 1)/threadCount);
+        int first = firstBlock*4;
+        int last = (lastBlock*4 < count) ? lastBlock*4 : count;
+        jobs[t].stream = *stream;
+        jobs[t].stream.counter += (uint64_t)firstBlock; // Блок зависит только от своего номера
+        jobs[t].out = out + first;
+        jobs[t].count = (last > first) ? last - first : 0;
+        pthread_create(&threads[t], NULL, FillThread, &jobs[t]);
+    }
+    for (int t = 0; t < threadCount; t++) pthread_join(threads[t], NULL);
+}
+
+static bool Check(const char *name, bool passed)
+{
+    printf("  %-48s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    int count = 4000000;
+    for (int i = 1; i + 1 < argc; i++) if (strcmp(argv[i], "--count") == 0) count = atoi(argv[i + 1]);
+    if (count < 64) count = 64;
+
+    int *reference = (int *)malloc(count*sizeof(int));
+    int *values = (int *)malloc(count*sizeof(int));
+    bool passed = true;
+
+    // Эталонный вектор
+    uint32_t block[4];
+    RngStream zero = CreateRngStream(0, 0);
+    RngPhilox(&zero, 0, block);
+    passed &= Check("Philox4x32-10 known-answer vector", block[0] == 0x6627E8D5u && block[1] == 0xE169C58Du && block[2] == 0xBC57AC4Cu && block[3] == 0x9B00DBD8u);
+
+    // Пакет против поштучной выдачи; длина не кратна блоку, чтобы проверить хвост
+    RngStream bulk = CreateRngStream(TEST_SEED, 1), scalar = CreateRngStream(TEST_SEED, 1);
+    int bulkCount = count - 3;
+    RngFillInts(&bulk, reference, bulkCount, TEST_MIN, TEST_MAX);
+    bool same = true;
+    for (int i = 0; i < bulkCount && same; i++) same = (RngNextInt(&scalar, TEST_MIN, TEST_MAX) == reference[i]);
+    passed &= Check("RngFillInts matches RngNextInt sequence", same);
+    RngPhilox(&bulk, (uint64_t)(bulkCount + 3)/4, block); // Пакет дописывает последний блок целиком
+    passed &= Check("stream continues after the last filled block", RngNextU32(&bulk) == block[0]);
+
+    // Разные потоки подсистем не совпадают
+    RngStream other = CreateRngStream(TEST_SEED, 2);
+    RngFillInts(&other, values, 64, TEST_MIN, TEST_MAX);
+    passed &= Check("different stream ids give different sequences", memcmp(values, reference, 64*sizeof(int)) != 0);
+
+    // Независимость от числа потоков
+    RngStream base = CreateRngStream(TEST_SEED, 1);
+    for (int threads = 1; threads <= TEST_MAX_THREADS; threads++) {
+        memset(values, 0, count*sizeof(int));
+        ParallelFill(&base, values, bulkCount, threads);
+        char name[64];
+        snprintf(name, sizeof(name), "RngFillInts split across %d thread(s)", threads);
+        passed &= Check(name, memcmp(values, reference, bulkCount*sizeof(int)) == 0);
+    }
+
+    // Замер: тот же объём чисел в том же диапазоне
+    printf("\n%-24s %12s\n", "path", "M values/s");
+    volatile long long sink = 0; // Чтобы цикл не выбросил оптимизатор
+    SetRandomSeed((unsigned int)TEST_SEED);
+    double start = NowSeconds();
+    for (int i = 0; i < count; i++) sink += GetRandomValue(TEST_MIN, TEST_MAX);
+    double perCall = NowSeconds() - start;
+
+    RngStream stream = CreateRngStream(TEST_SEED, 1);
+    start = NowSeconds();
+    for (int i = 0; i < count; i++) sink += RngNextInt(&stream, TEST_MIN, TEST_MAX);
+    double scalarSeconds = NowSeconds() - start;
+
+    start = NowSeconds();
+    RngFillInts(&stream, values, count, TEST_MIN, TEST_MAX);
+    double bulkSeconds = NowSeconds() - start;
+    sink += values[count - 1];
+
+    printf("%-24s %12.1f\n", "GetRandomValue", count/perCall/1e6);
+    printf("%-24s %12.1f\n", "RngNextInt", count/scalarSeconds/1e6);
+    printf("%-24s %12.1f\n", "RngFillInts", count/bulkSeconds/1e6);
+
+    free(reference);
+    free(values);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,408 @@
+/*******************************************************************************************
+*
+*   state_trace - сжатая запись состояния игрока и камеры по тикам
+*
+*   Каждый тик - набор целых полей в фиксированной точке (TraceFrame). Поле кодируется
+*   второй разностью: предсказание prev + (prev - prevPrev), в файл идёт отклонение от него.
+*   При покое и равномерном движении отклонения нулевые, и тик занимает 1-2 байта:
+*   varint-маска ненулевых полей и zigzag-varint отклонения только для них.
+*
+*   Файл пишется потоково блоками по TRACE_KEYFRAME_INTERVAL тиков. Первый тик блока -
+*   ключевой кадр с абсолютными значениями, поэтому любой блок декодируется независимо:
+*   переход к тику - прыжок по заголовкам блоков и декодирование не более одного блока.
+*   Блок целиком копится в памяти и пишется одним fwrite; оборванный файл теряет только
+*   последний блок.
+*
+*   Формат (little-endian):
+*       заголовок файла: u32 magic 'PTRC', u16 version, u16 fieldCount, u32 keyframeInterval
+*       блок: u32 magic 'TRCK', u32 startTick, u16 tickCount, u32 payloadBytes, payload
+*
+*   Использование:
+*       #define STATE_TRACE_IMPLEMENTATION
+*       #include "state_trace.h"
+*
+********************************************************************************************/
+
+#ifndef STATE_TRACE_H
+#define STATE_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRACE_MAGIC 0x43525450u             // 'PTRC'
+#define TRACE_CHUNK_MAGIC 0x4B435254u       // 'TRCK'
+#define TRACE_VERSION 1                     // Версия формата
+#define TRACE_KEYFRAME_INTERVAL 1024        // Тиков в блоке (~7 сек при 144 FPS)
+#define TRACE_CHUNK_HEADER_SIZE 14          // Байт в заголовке блока
+#define TRACE_MAX_VARINT 10                 // Максимум байт в varint (64 бита)
+#define TRACE_FILE_BUFFER_SIZE 65536        // Буфер stdio (выделен заранее)
+
+// --- Поля тика ---
+typedef enum {
+    TRACE_DT_US = 0,          // Длительность тика (мкс)
+    TRACE_POSITION_X,         // Позиция игрока (1/256 пикселя)
+    TRACE_POSITION_Y,
+    TRACE_SPEED,              // Вертикальная скорость (1/16 пикс/сек)
+    TRACE_VELOCITY_X,         // Горизонтальная скорость (1/16 пикс/сек)
+    TRACE_JUMP_COUNT,         // Счётчик прыжков
+    TRACE_DASH_TIME,          // Оставшееся время рывка (мкс)
+    TRACE_FLAGS,              // Флаги TRACE_FLAG_*
+    TRACE_CAMERA_TARGET_X,    // Цель камеры (1/256 пикселя)
+    TRACE_CAMERA_TARGET_Y,
+    TRACE_CAMERA_OFFSET_X,    // Смещение камеры (1/256 пикселя)
+    TRACE_CAMERA_OFFSET_Y,
+    TRACE_CAMERA_ZOOM,        // Масштаб камеры (1/4096)
+    TRACE_CAMERA_MODE,        // Режим камеры
+    TRACE_FIELD_COUNT
+} TraceField;
+
+// --- Флаги состояния игрока ---
+#define TRACE_FLAG_CAN_JUMP     0x01  // Может прыгать
+#define TRACE_FLAG_JUMPING      0x02  // Сейчас прыгает
+#define TRACE_FLAG_DASHING      0x04  // Выполняется рывок
+#define TRACE_FLAG_SUPER_JUMP   0x08  // Супер-прыжок
+#define TRACE_FLAG_DROP_DOWN    0x10  // Спрыгивает с JumpThru
+#define TRACE_FLAG_ON_GROUND    0x20  // Стоит на земле
+#define TRACE_FLAG_FACING_LEFT  0x40  // Смотрит влево
+
+// --- Состояние одного тика ---
+typedef struct TraceFrame {
+    int32_t values[TRACE_FIELD_COUNT]; // Поля в фиксированной точке
+} TraceFrame;
+
+// --- Потоковая запись (всё выделено статически вместе со структурой) ---
+typedef struct TraceWriter {
+    FILE *file;                               // Файл записи (NULL - запись выключена)
+    uint32_t tickCount;                       // Записано тиков
+    uint64_t bytesWritten;                    // Записано байт
+    uint32_t chunkStartTick;                  // Первый тик текущего блока
+    int chunkTicks;                           // Тиков в текущем блоке
+    size_t chunkBytes;                        // Байт в текущем блоке
+    int32_t prev[TRACE_FIELD_COUNT];          // Значения прошлого тика
+    int32_t prevDelta[TRACE_FIELD_COUNT];     // Разности прошлого тика
+    unsigned char fileBuffer[TRACE_FILE_BUFFER_SIZE]; // Буфер stdio
+    unsigned char chunk[TRACE_CHUNK_HEADER_SIZE + TRACE_KEYFRAME_INTERVAL*(3 + TRACE_FIELD_COUNT*TRACE_MAX_VARINT)]; // Блок худшего размера
+} TraceWriter;
+
+// --- Положение блока в файле ---
+typedef struct TraceChunkInfo {
+    long offset;            // Начало payload в файле
+    uint32_t startTick;     // Первый тик блока
+    int tickCount;          // Тиков в блоке
+    uint32_t payloadBytes;  // Размер payload
+} TraceChunkInfo;
+
+// --- Чтение с переходом к любому тику ---
+typedef struct TraceReader {
+    FILE *file;                           // Файл трассы
+    TraceChunkInfo *chunks;               // Оглавление блоков
+    int chunkCount;                       // Количество блоков
+    uint32_t tickCount;                   // Всего тиков
+    unsigned char *payload;               // Payload текущего блока
+    int chunk;                            // Текущий блок (-1 - не загружен)
+    size_t position;                      // Позиция в payload
+    uint32_t tick;                        // Следующий тик для чтения
+    int32_t prev[TRACE_FIELD_COUNT];      // Значения прошлого тика
+    int32_t prevDelta[TRACE_FIELD_COUNT]; // Разности прошлого тика
+} TraceReader;
+
+int32_t TraceQuantize(TraceField field, float value);         // Значение -> фиксированная точка поля
+float TraceDequantize(TraceField field, int32_t value);       // Фиксированная точка поля -> значение
+const char *TraceFieldName(TraceField field);                 // Имя поля (для отчётов)
+
+bool OpenTraceWriter(TraceWriter *writer, const char *fileName);     // Начать запись
+void CloseTraceWriter(TraceWriter *writer);                          // Дописать блок и закрыть
+void TraceWriteFrame(TraceWriter *writer, const TraceFrame *frame);  // Записать тик
+
+bool OpenTraceReader(TraceReader *reader, const char *fileName);     // Открыть и построить оглавление
+void CloseTraceReader(TraceReader *reader);                          // Закрыть
+bool TraceSeek(TraceReader *reader, uint32_t tick);                  // Следующим будет прочитан тик tick
+bool TraceReadFrame(TraceReader *reader, TraceFrame *frame);         // Прочитать следующий тик
+bool TraceReadChunkPayload(TraceReader *reader, int chunk, unsigned char *out); // Сырые байты блока (для сравнения)
+
+#endif // STATE_TRACE_H
+
+/***********************************************************************************
+*
+*   STATE_TRACE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(STATE_TRACE_IMPLEMENTATION) && !defined(STATE_TRACE_IMPLEMENTED)
+#define STATE_TRACE_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Масштаб фиксированной точки для каждого поля
+static const float traceFieldScale[TRACE_FIELD_COUNT] = {
+    1000000.0f, 256.0f, 256.0f, 16.0f, 16.0f, 1.0f, 1000000.0f, 1.0f,
+    256.0f, 256.0f, 256.0f, 256.0f, 4096.0f, 1.0f
+};
+
+static const char *traceFieldNames[TRACE_FIELD_COUNT] = {
+    "dt", "position.x", "position.y", "speed", "velocityX", "jumpCount", "dashTime", "flags",
+    "camera.target.x", "camera.target.y", "camera.offset.x", "camera.offset.y", "camera.zoom", "cameraMode"
+};
+
+int32_t TraceQuantize(TraceField field, float value)
+{
+    return (int32_t)lroundf(value*traceFieldScale[field]);
+}
+
+float TraceDequantize(TraceField field, int32_t value)
+{
+    return value/traceFieldScale[field];
+}
+
+const char *TraceFieldName(TraceField field)
+{
+    return traceFieldNames[field];
+}
+
+// --- Кодирование чисел ---
+static unsigned char *TracePut(unsigned char *p, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) *p++ = (unsigned char)(value >> (8*i));
+    return p;
+}
+
+static uint64_t TraceGet(const unsigned char *p, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= (uint64_t)p[i] << (8*i);
+    return value;
+}
+
+static unsigned char *TracePutVarint(unsigned char *p, uint64_t value)
+{
+    while (value >= 0x80) { *p++ = (unsigned char)(value | 0x80); value >>= 7; }
+    *p++ = (unsigned char)value;
+    return p;
+}
+
+static bool TraceGetVarint(const unsigned char *p, size_t size, size_t *position, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *position < size; shift += 7) {
+        unsigned char byte = p[(*position)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t TraceZigzag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+static int64_t TraceUnzigzag(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+// --- Запись ---
+bool OpenTraceWriter(TraceWriter *writer, const char *fileName)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->file = fopen(fileName, "wb");
+    if (writer->file == NULL) return false;
+    setvbuf(writer->file, (char *)writer->fileBuffer, _IOFBF, sizeof(writer->fileBuffer));
+
+    unsigned char header[12];
+    unsigned char *p = header;
+    p = TracePut(p, TRACE_MAGIC, 4);
+    p = TracePut(p, TRACE_VERSION, 2);
+    p = TracePut(p, TRACE_FIELD_COUNT, 2);
+    p = TracePut(p, TRACE_KEYFRAME_INTERVAL, 4);
+    fwrite(header, 1, sizeof(header), writer->file);
+    writer->bytesWritten = sizeof(header);
+    return true;
+}
+
+// Дописать заголовок в начало блока и отправить блок в файл
+static void TraceFlushChunk(TraceWriter *writer)
+{
+    if (writer->chunkTicks == 0) return;
+    unsigned char *p = writer->chunk;
+    p = TracePut(p, TRACE_CHUNK_MAGIC, 4);
+    p = TracePut(p, writer->chunkStartTick, 4);
+    p = TracePut(p, (uint32_t)writer->chunkTicks, 2);
+    TracePut(p, (uint32_t)(writer->chunkBytes - TRACE_CHUNK_HEADER_SIZE), 4);
+    fwrite(writer->chunk, 1, writer->chunkBytes, writer->file);
+    writer->bytesWritten += writer->chunkBytes;
+    writer->chunkTicks = 0;
+}
+
+void CloseTraceWriter(TraceWriter *writer)
+{
+    if (writer->file == NULL) return;
+    TraceFlushChunk(writer);
+    fclose(writer->file);
+    writer->file = NULL;
+}
+
+void TraceWriteFrame(TraceWriter *writer, const TraceFrame *frame)
+{
+    if (writer->file == NULL) return;
+
+    // Полный блок уходит в файл, новый начинается с ключевого кадра
+    if (writer->chunkTicks == TRACE_KEYFRAME_INTERVAL) TraceFlushChunk(writer);
+
+    unsigned char *p;
+    if (writer->chunkTicks == 0) {
+        writer->chunkStartTick = writer->tickCount;
+        p = writer->chunk + TRACE_CHUNK_HEADER_SIZE;
+        for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+            p = TracePutVarint(p, TraceZigzag(frame->values[f]));
+            writer->prev[f] = frame->values[f];
+            writer->prevDelta[f] = 0;
+        }
+    } else {
+        // Отклонения от линейного предсказания; маска перед ними
+        int64_t residual[TRACE_FIELD_COUNT];
+        uint32_t mask = 0;
+        for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+            int64_t delta = (int64_t)frame->values[f] - writer->prev[f];
+            residual[f] = delta - writer->prevDelta[f];
+            if (residual[f] != 0) mask |= 1u << f;
+            writer->prevDelta[f] = (int32_t)delta;
+            writer->prev[f] = frame->values[f];
+        }
+        p = TracePutVarint(writer->chunk + writer->chunkBytes, mask);
+        for (int f = 0; f < TRACE_FIELD_COUNT; f++) if (mask & (1u << f)) p = TracePutVarint(p, TraceZigzag(residual[f]));
+    }
+
+    writer->chunkBytes = (size_t)(p - writer->chunk);
+    writer->chunkTicks++;
+    writer->tickCount++;
+}
+
+// --- Чтение ---
+bool OpenTraceReader(TraceReader *reader, const char *fileName)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->chunk = -1;
+    reader->file = fopen(fileName, "rb");
+    if (reader->file == NULL) return false;
+
+    unsigned char header[12];
+    if (fread(header, 1, sizeof(header), reader->file) != sizeof(header) ||
+        TraceGet(header, 4) != TRACE_MAGIC || TraceGet(header + 4, 2) != TRACE_VERSION || TraceGet(header + 6, 2) != TRACE_FIELD_COUNT) {
+        CloseTraceReader(reader);
+        return false;
+    }
+
+    // Оглавление: проход только по заголовкам блоков
+    int capacity = 0;
+    uint32_t maxPayload = 0;
+    unsigned char chunkHeader[TRACE_CHUNK_HEADER_SIZE];
+    while (fread(chunkHeader, 1, sizeof(chunkHeader), reader->file) == sizeof(chunkHeader)) {
+        if (TraceGet(chunkHeader, 4) != TRACE_CHUNK_MAGIC) break;
+        TraceChunkInfo info = { ftell(reader->file), (uint32_t)TraceGet(chunkHeader + 4, 4), (int)TraceGet(chunkHeader + 8, 2), (uint32_t)TraceGet(chunkHeader + 10, 4) };
+        if (info.startTick != reader->tickCount || fseek(reader->file, (long)info.payloadBytes, SEEK_CUR) != 0) break;
+        if (reader->chunkCount == capacity) {
+            capacity = (capacity == 0) ? 64 : capacity*2;
+            reader->chunks = (TraceChunkInfo *)realloc(reader->chunks, capacity*sizeof(TraceChunkInfo));
+        }
+        reader->chunks[reader->chunkCount++] = info;
+        reader->tickCount += info.tickCount;
+        if (info.payloadBytes > maxPayload) maxPayload = info.payloadBytes;
+    }
+
+    // Оборванный последний блок отбрасывается
+    if (reader->chunkCount > 0) {
+        TraceChunkInfo *last = &reader->chunks[reader->chunkCount - 1];
+        fseek(reader->file, 0, SEEK_END);
+        if (ftell(reader->file) < last->offset + (long)last->payloadBytes) {
+            reader->tickCount -= last->tickCount;
+            reader->chunkCount--;
+        }
+    }
+
+    reader->payload = (unsigned char *)malloc((maxPayload > 0) ? maxPayload : 1);
+    return true;
+}
+
+void CloseTraceReader(TraceReader *reader)
+{
+    if (reader->file != NULL) fclose(reader->file);
+    free(reader->chunks);
+    free(reader->payload);
+    memset(reader, 0, sizeof(*reader));
+    reader->chunk = -1;
+}
+
+bool TraceReadChunkPayload(TraceReader *reader, int chunk, unsigned char *out)
+{
+    const TraceChunkInfo *info = &reader->chunks[chunk];
+    if (fseek(reader->file, info->offset, SEEK_SET) != 0) return false;
+    return fread(out, 1, info->payloadBytes, reader->file) == info->payloadBytes;
+}
+
+// Декодировать следующий тик текущего блока
+static bool TraceDecodeFrame(TraceReader *reader, TraceFrame *frame)
+{
+    const TraceChunkInfo *info = &reader->chunks[reader->chunk];
+    uint64_t value;
+    if (reader->tick == info->startTick) {
+        for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+            if (!TraceGetVarint(reader->payload, info->payloadBytes, &reader->position, &value)) return false;
+            reader->prev[f] = (int32_t)TraceUnzigzag(value);
+            reader->prevDelta[f] = 0;
+        }
+    } else {
+        uint64_t mask;
+        if (!TraceGetVarint(reader->payload, info->payloadBytes, &reader->position, &mask)) return false;
+        for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+            int64_t residual = 0;
+            if (mask & (1u << f)) {
+                if (!TraceGetVarint(reader->payload, info->payloadBytes, &reader->position, &value)) return false;
+                residual = TraceUnzigzag(value);
+            }
+            reader->prevDelta[f] = (int32_t)(reader->prevDelta[f] + residual);
+            reader->prev[f] = (int32_t)((uint32_t)reader->prev[f] + (uint32_t)reader->prevDelta[f]); // По модулю 2^32, как у записи
+        }
+    }
+    if (frame != NULL) memcpy(frame->values, reader->prev, sizeof(frame->values));
+    reader->tick++;
+    return true;
+}
+
+// Загрузить блок и встать на его ключевой кадр
+static bool TraceLoadChunk(TraceReader *reader, int chunk)
+{
+    if (!TraceReadChunkPayload(reader, chunk, reader->payload)) return false;
+    reader->chunk = chunk;
+    reader->position = 0;
+    reader->tick = reader->chunks[chunk].startTick;
+    return true;
+}
+
+bool TraceSeek(TraceReader *reader, uint32_t tick)
+{
+    if (tick >= reader->tickCount) return false;
+
+    // Двоичный поиск блока по первому тику
+    int lo = 0, hi = reader->chunkCount - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1)/2;
+        if (reader->chunks[mid].startTick <= tick) lo = mid;
+        else hi = mid - 1;
+    }
+
+    // Внутри уже загруженного блока можно идти вперёд без перечитывания
+    if (reader->chunk != lo || reader->tick > tick) {
+        if (!TraceLoadChunk(reader, lo)) return false;
+    }
+    while (reader->tick < tick) if (!TraceDecodeFrame(reader, NULL)) return false;
+    return true;
+}
+
+bool TraceReadFrame(TraceReader *reader, TraceFrame *frame)
+{
+    if (reader->tick >= reader->tickCount) return false;
+    int next = reader->chunk + 1;
+    if (reader->chunk < 0 || reader->tick == reader->chunks[reader->chunk].startTick + (uint32_t)reader->chunks[reader->chunk].tickCount) {
+        if (next >= reader->chunkCount || !TraceLoadChunk(reader, next)) return false;
+    }
+    return TraceDecodeFrame(reader, frame);
+}
+
+#endif // STATE_TRACE_IMPLEMENTATION
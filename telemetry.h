@@ -0,0 +1,225 @@
+/*******************************************************************************************
+*
+*   telemetry - гистограммы для долгих прогонов без выделения памяти в кадре
+*
+*   Каждый канал - гистограмма с фиксированными лог-линейными корзинами (как HDR Histogram:
+*   16 корзин на каждую степень двойки, точность ~6%). Запись значения - только инкремент
+*   счётчика. Раз в flushInterval секунд накопленное сбрасывается одной компактной бинарной
+*   записью в файл (подойдёт и именованный канал) и гистограммы обнуляются.
+*
+*   Формат записи (little-endian):
+*       u32 magic 'PTLM', u16 version, u16 channelCount, u32 sequence, u32 intervalUs,
+*       u8 cameraModeCount, u32 cameraModeUs[cameraModeCount],
+*       для каждого канала: u32 total, u32 min, u32 max, u64 sum, u16 nonZero,
+*                           nonZero x (u16 bucket, u32 count)
+*
+*   Использование:
+*       #define TELEMETRY_IMPLEMENTATION
+*       #include "telemetry.h"
+*
+********************************************************************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TELEMETRY_MAGIC 0x4D4C5450u          // 'PTLM'
+#define TELEMETRY_VERSION 1                  // Версия формата записи
+#define TELEMETRY_SUB_BUCKETS 16             // Корзин на степень двойки
+#define TELEMETRY_SUB_BITS 4                 // log2(TELEMETRY_SUB_BUCKETS)
+#define TELEMETRY_BUCKETS ((32 - TELEMETRY_SUB_BITS + 1)*TELEMETRY_SUB_BUCKETS) // Корзин на весь диапазон u32
+#define TELEMETRY_MAX_CAMERA_MODES 8         // Максимум режимов камеры
+#define TELEMETRY_FILE_BUFFER_SIZE 65536     // Буфер stdio (выделен заранее)
+
+// --- Каналы ---
+typedef enum {
+    TELEMETRY_FRAME_TIME_US = 0,      // Время кадра (мкс)
+    TELEMETRY_ACTIVE_PARTICLES,       // Активных частиц в кадре
+    TELEMETRY_COLLISION_CANDIDATES,   // Кандидатов на коллизию за тик
+    TELEMETRY_SPAWN_BURST,            // Частиц в одном выбросе пыли
+    TELEMETRY_CHANNEL_COUNT
+} TelemetryChannel;
+
+// --- Гистограмма одного канала ---
+typedef struct TelemetryHistogram {
+    uint32_t counts[TELEMETRY_BUCKETS]; // Счётчики корзин
+    uint32_t total;                     // Всего значений
+    uint32_t min, max;                  // Крайние значения
+    uint64_t sum;                       // Сумма (для среднего)
+} TelemetryHistogram;
+
+// --- Состояние телеметрии (всё выделено статически вместе со структурой) ---
+typedef struct Telemetry {
+    FILE *file;                 // Куда пишутся записи (NULL - телеметрия выключена)
+    float flushInterval;        // Период сброса (сек)
+    float sinceFlush;           // Время с последнего сброса
+    uint32_t sequence;          // Номер следующей записи
+    int cameraModeCount;        // Количество режимов камеры
+    uint64_t cameraModeUs[TELEMETRY_MAX_CAMERA_MODES];          // Время в каждом режиме за интервал (мкс)
+    TelemetryHistogram channels[TELEMETRY_CHANNEL_COUNT];       // Гистограммы
+    unsigned char fileBuffer[TELEMETRY_FILE_BUFFER_SIZE];       // Буфер stdio
+    unsigned char record[TELEMETRY_CHANNEL_COUNT*(22 + 6*TELEMETRY_BUCKETS) + 17 + 4*TELEMETRY_MAX_CAMERA_MODES]; // Буфер записи
+} Telemetry;
+
+bool OpenTelemetry(Telemetry *telemetry, const char *fileName, float flushInterval, int cameraModeCount); // Начать запись
+void CloseTelemetry(Telemetry *telemetry);                                                            // Сбросить остаток и закрыть
+
+void TelemetryRecord(Telemetry *telemetry, TelemetryChannel channel, uint32_t value); // Добавить значение в канал
+void TelemetryCameraTime(Telemetry *telemetry, int cameraMode, float delta);          // Учесть время в режиме камеры
+void TelemetryUpdate(Telemetry *telemetry, float delta);                              // Сбросить запись, если подошёл срок
+void TelemetryFlush(Telemetry *telemetry);                                            // Сбросить запись сейчас
+
+void TelemetryHistogramAdd(TelemetryHistogram *histogram, uint32_t value);    // Добавить значение
+int TelemetryBucketIndex(uint32_t value);                                     // Корзина для значения
+uint32_t TelemetryBucketUpperBound(int bucket);                               // Наибольшее значение в корзине
+uint32_t TelemetryPercentile(const TelemetryHistogram *histogram, double percentile); // Перцентиль (0..100)
+
+#endif // TELEMETRY_H
+
+/***********************************************************************************
+*
+*   TELEMETRY IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(TELEMETRY_IMPLEMENTATION) && !defined(TELEMETRY_IMPLEMENTED)
+#define TELEMETRY_IMPLEMENTED // Повторное включение не дублирует реализацию
+
+#include <string.h>
+
+// --- Корзины: значения < 16 точные, дальше 16 корзин на каждую степень двойки ---
+int TelemetryBucketIndex(uint32_t value)
+{
+    if (value < TELEMETRY_SUB_BUCKETS) return (int)value;
+    int exponent = 31;
+    while (!(value & (1u << exponent))) exponent--;
+    int shift = exponent - TELEMETRY_SUB_BITS;
+    int sub = (int)((value >> shift) & (TELEMETRY_SUB_BUCKETS - 1));
+    return (shift + 1)*TELEMETRY_SUB_BUCKETS + sub;
+}
+
+uint32_t TelemetryBucketUpperBound(int bucket)
+{
+    if (bucket < TELEMETRY_SUB_BUCKETS) return (uint32_t)bucket;
+    int shift = bucket/TELEMETRY_SUB_BUCKETS - 1;
+    uint64_t lower = ((uint64_t)(TELEMETRY_SUB_BUCKETS + bucket%TELEMETRY_SUB_BUCKETS)) << shift;
+    uint64_t upper = lower + ((uint64_t)1 << shift) - 1;
+    return (upper > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)upper;
+}
+
+void TelemetryHistogramAdd(TelemetryHistogram *histogram, uint32_t value)
+{
+    histogram->counts[TelemetryBucketIndex(value)]++;
+    if (histogram->total == 0 || value < histogram->min) histogram->min = value;
+    if (histogram->total == 0 || value > histogram->max) histogram->max = value;
+    histogram->total++;
+    histogram->sum += value;
+}
+
+uint32_t TelemetryPercentile(const TelemetryHistogram *histogram, double percentile)
+{
+    if (histogram->total == 0) return 0;
+    uint64_t rank = (uint64_t)(percentile/100.0*histogram->total + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < TELEMETRY_BUCKETS; b++) {
+        seen += histogram->counts[b];
+        if (seen >= rank) {
+            uint32_t value = TelemetryBucketUpperBound(b);
+            return (value > histogram->max) ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+// --- Запись ---
+bool OpenTelemetry(Telemetry *telemetry, const char *fileName, float flushInterval, int cameraModeCount)
+{
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->file = fopen(fileName, "wb");
+    if (telemetry->file == NULL) return false;
+    setvbuf(telemetry->file, (char *)telemetry->fileBuffer, _IOFBF, sizeof(telemetry->fileBuffer));
+    telemetry->flushInterval = flushInterval;
+    telemetry->cameraModeCount = (cameraModeCount < TELEMETRY_MAX_CAMERA_MODES) ? cameraModeCount : TELEMETRY_MAX_CAMERA_MODES;
+    return true;
+}
+
+void CloseTelemetry(Telemetry *telemetry)
+{
+    if (telemetry->file == NULL) return;
+    TelemetryFlush(telemetry);
+    fclose(telemetry->file);
+    telemetry->file = NULL;
+}
+
+void TelemetryRecord(Telemetry *telemetry, TelemetryChannel channel, uint32_t value)
+{
+    if (telemetry->file != NULL) TelemetryHistogramAdd(&telemetry->channels[channel], value);
+}
+
+void TelemetryCameraTime(Telemetry *telemetry, int cameraMode, float delta)
+{
+    if (telemetry->file != NULL && cameraMode >= 0 && cameraMode < telemetry->cameraModeCount)
+        telemetry->cameraModeUs[cameraMode] += (uint64_t)(delta*1000000.0f);
+}
+
+void TelemetryUpdate(Telemetry *telemetry, float delta)
+{
+    if (telemetry->file == NULL) return;
+    telemetry->sinceFlush += delta;
+    if (telemetry->sinceFlush >= telemetry->flushInterval) TelemetryFlush(telemetry);
+}
+
+static unsigned char *TelemetryPut(unsigned char *p, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) *p++ = (unsigned char)(value >> (8*i));
+    return p;
+}
+
+void TelemetryFlush(Telemetry *telemetry)
+{
+    if (telemetry->file == NULL) return;
+
+    unsigned char *p = telemetry->record;
+    p = TelemetryPut(p, TELEMETRY_MAGIC, 4);
+    p = TelemetryPut(p, TELEMETRY_VERSION, 2);
+    p = TelemetryPut(p, TELEMETRY_CHANNEL_COUNT, 2);
+    p = TelemetryPut(p, telemetry->sequence++, 4);
+    p = TelemetryPut(p, (uint32_t)(telemetry->sinceFlush*1000000.0f), 4);
+    p = TelemetryPut(p, (uint32_t)telemetry->cameraModeCount, 1);
+    for (int m = 0; m < telemetry->cameraModeCount; m++) {
+        uint64_t us = telemetry->cameraModeUs[m];
+        p = TelemetryPut(p, (us > 0xFFFFFFFFu) ? 0xFFFFFFFFu : us, 4);
+    }
+
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        const TelemetryHistogram *h = &telemetry->channels[c];
+        p = TelemetryPut(p, h->total, 4);
+        p = TelemetryPut(p, h->min, 4);
+        p = TelemetryPut(p, h->max, 4);
+        p = TelemetryPut(p, h->sum, 8);
+        unsigned char *nonZeroAt = p;
+        p += 2;
+        int nonZero = 0;
+        for (int b = 0; b < TELEMETRY_BUCKETS; b++) {
+            if (h->counts[b] == 0) continue;
+            p = TelemetryPut(p, (uint32_t)b, 2);
+            p = TelemetryPut(p, h->counts[b], 4);
+            nonZero++;
+        }
+        TelemetryPut(nonZeroAt, (uint32_t)nonZero, 2);
+    }
+
+    fwrite(telemetry->record, 1, (size_t)(p - telemetry->record), telemetry->file);
+    fflush(telemetry->file);
+
+    // Новый интервал
+    memset(telemetry->channels, 0, sizeof(telemetry->channels));
+    memset(telemetry->cameraModeUs, 0, sizeof(telemetry->cameraModeUs));
+    telemetry->sinceFlush = 0.0f;
+}
+
+#endif // TELEMETRY_IMPLEMENTATION
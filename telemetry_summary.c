@@ -0,0 +1,130 @@
+#include <stdio.h> // Для вывода сводки
+#include <stdlib.h>
+#include <string.h>
+/*******************************************************************************************
+*
+*   telemetry_summary - сводка файла телеметрии в перцентили
+*
+*   Читает все записи, складывает гистограммы интервалов и печатает по каждому каналу
+*   количество, среднее, min, p50/p90/p99/p99.9, max, а также время в режимах камеры
+*   и худший по p99 времени кадра интервал.
+*
+*   Запуск: telemetry_summary soak.ptlm
+*
+********************************************************************************************/
+
+#define TELEMETRY_IMPLEMENTATION
+#include "telemetry.h" // Формат записи и гистограммы
+
+static const char *channelNames[TELEMETRY_CHANNEL_COUNT] = {
+    "frame time (us)",
+    "active particles",
+    "collision candidates",
+    "spawn burst size",
+};
+
+// --- Чтение little-endian числа ---
+static bool ReadValue(FILE *file, uint64_t *value, int bytes)
+{
+    unsigned char buffer[8];
+    if (fread(buffer, 1, bytes, file) != (size_t)bytes) return false;
+    *value = 0;
+    for (int i = 0; i < bytes; i++) *value |= (uint64_t)buffer[i] << (8*i);
+    return true;
+}
+
+// --- Чтение одной записи: гистограммы интервала добавляются к итоговым ---
+static bool ReadRecord(FILE *file, TelemetryHistogram *interval, TelemetryHistogram *merged, uint64_t *cameraModeUs, int *cameraModeCount, uint64_t *intervalUs)
+{
+    uint64_t magic, version, channelCount, sequence, modes;
+    if (!ReadValue(file, &magic, 4)) return false;
+    if (magic != TELEMETRY_MAGIC) { fprintf(stderr, "Bad record magic\n"); return false; }
+    if (!ReadValue(file, &version, 2) || version != TELEMETRY_VERSION) { fprintf(stderr, "Unsupported version\n"); return false; }
+    if (!ReadValue(file, &channelCount, 2) || channelCount > TELEMETRY_CHANNEL_COUNT) return false;
+    if (!ReadValue(file, &sequence, 4) || !ReadValue(file, intervalUs, 4)) return false;
+    if (!ReadValue(file, &modes, 1) || modes > TELEMETRY_MAX_CAMERA_MODES) return false;
+    if ((int)modes > *cameraModeCount) *cameraModeCount = (int)modes;
+    for (uint64_t m = 0; m < modes; m++) {
+        uint64_t us;
+        if (!ReadValue(file, &us, 4)) return false;
+        cameraModeUs[m] += us;
+    }
+
+    for (uint64_t c = 0; c < channelCount; c++) {
+        TelemetryHistogram *h = &interval[c];
+        uint64_t total, min, max, sum, nonZero;
+        memset(h, 0, sizeof(*h));
+        if (!ReadValue(file, &total, 4) || !ReadValue(file, &min, 4) || !ReadValue(file, &max, 4) || !ReadValue(file, &sum, 8) || !ReadValue(file, &nonZero, 2)) return false;
+        h->total = (uint32_t)total;
+        h->min = (uint32_t)min;
+        h->max = (uint32_t)max;
+        h->sum = sum;
+        for (uint64_t i = 0; i < nonZero; i++) {
+            uint64_t bucket, count;
+            if (!ReadValue(file, &bucket, 2) || !ReadValue(file, &count, 4) || bucket >= TELEMETRY_BUCKETS) return false;
+            h->counts[bucket] = (uint32_t)count;
+        }
+
+        // Сложение с итоговой гистограммой
+        TelemetryHistogram *m = &merged[c];
+        if (h->total > 0) {
+            if (m->total == 0 || h->min < m->min) m->min = h->min;
+            if (m->total == 0 || h->max > m->max) m->max = h->max;
+        }
+        m->total += h->total;
+        m->sum += h->sum;
+        for (int b = 0; b < TELEMETRY_BUCKETS; b++) m->counts[b] += h->counts[b];
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: telemetry_summary <file.ptlm>\n");
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open: %s\n", argv[1]);
+        return 1;
+    }
+
+    TelemetryHistogram *merged = (TelemetryHistogram *)calloc(TELEMETRY_CHANNEL_COUNT, sizeof(TelemetryHistogram));
+    TelemetryHistogram *interval = (TelemetryHistogram *)calloc(TELEMETRY_CHANNEL_COUNT, sizeof(TelemetryHistogram));
+    uint64_t cameraModeUs[TELEMETRY_MAX_CAMERA_MODES] = { 0 };
+    int cameraModeCount = 0;
+    uint64_t totalUs = 0;
+    int records = 0;
+    int worstRecord = -1;
+    uint32_t worstP99 = 0;
+
+    uint64_t intervalUs;
+    while (ReadRecord(file, interval, merged, cameraModeUs, &cameraModeCount, &intervalUs)) {
+        uint32_t p99 = TelemetryPercentile(&interval[TELEMETRY_FRAME_TIME_US], 99.0);
+        if (worstRecord < 0 || p99 > worstP99) { worstP99 = p99; worstRecord = records; }
+        totalUs += intervalUs;
+        records++;
+    }
+    fclose(file);
+
+    printf("%d records, %.1f min recorded\n\n", records, totalUs/60000000.0);
+    printf("%-22s %12s %10s %8s %8s %8s %8s %8s %8s\n", "channel", "count", "mean", "min", "p50", "p90", "p99", "p99.9", "max");
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        const TelemetryHistogram *h = &merged[c];
+        double mean = (h->total > 0) ? (double)h->sum/h->total : 0.0;
+        printf("%-22s %12u %10.1f %8u %8u %8u %8u %8u %8u\n", channelNames[c], h->total, mean, h->min,
+               TelemetryPercentile(h, 50.0), TelemetryPercentile(h, 90.0), TelemetryPercentile(h, 99.0), TelemetryPercentile(h, 99.9), h->max);
+    }
+
+    printf("\ncamera mode time:\n");
+    for (int m = 0; m < cameraModeCount; m++)
+        printf("  mode %d: %10.1f s (%5.1f%%)\n", m, cameraModeUs[m]/1000000.0, (totalUs > 0) ? 100.0*cameraModeUs[m]/totalUs : 0.0);
+
+    if (worstRecord >= 0) printf("\nworst interval by frame time p99: record %d, p99 %u us\n", worstRecord, worstP99);
+
+    free(merged);
+    free(interval);
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*******************************************************************************************
+*
+*   tool_timer - общий таймер консольных утилит
+*
+*   Монотонное время в секундах для замеров в утилитах без окна (GetTime() из raylib
+*   без InitWindow недоступен). Утилиты собираются отдельно от игры: make <имя утилиты>
+*   или make tools (список TOOLS в Makefile).
+*
+*   Использование:
+*       #include "tool_timer.h"
+*       double start = NowSeconds();
+*
+********************************************************************************************/
+
+#ifndef TOOL_TIMER_H
+#define TOOL_TIMER_H
+
+#include <time.h> // clock_gettime (нужен -D_DEFAULT_SOURCE при -std=c99, есть в CFLAGS)
+
+// Монотонное время в секундах
+static inline double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+#endif // TOOL_TIMER_H
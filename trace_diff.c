@@ -0,0 +1,126 @@
+#include <stdio.h> // Для вывода отчёта
+#include <stdlib.h>
+#include <string.h>
+/*******************************************************************************************
+*
+*   trace_diff - первый тик, на котором расходятся две трассы состояния
+*
+*   Сравнивает трассы по тикам, включая длительность тика (dt). Сравнение имеет смысл только
+*   для прогонов с фиксированным шагом или воспроизведения записанного ввода: у живых забегов
+*   GetFrameTime() всегда разный, позиции интегрируют разный dt и расходятся в любом случае.
+*   С --ignore-dt dt не сравнивается, но первый тик, где он разошёлся, всё равно печатается -
+*   иначе дрейф позиций не объяснить. Блоки обеих трасс начинаются на одних и тех же тиках,
+*   поэтому блоки с одинаковыми байтами пропускаются без декодирования.
+*   Печатает тик расхождения и отличающиеся поля.
+*
+*   Запуск: trace_diff [--ignore-dt] run_a.ptrc run_b.ptrc
+*   Код возврата: 0 - совпадают, 1 - расходятся, 2 - ошибка чтения
+*
+********************************************************************************************/
+
+#define STATE_TRACE_IMPLEMENTATION
+#include "state_trace.h" // Формат трассы
+
+// --- Сравнение тиков: dt не учитывается только по запросу ---
+static bool FramesEqual(const TraceFrame *a, const TraceFrame *b, bool includeDt)
+{
+    for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+        if (f == TRACE_DT_US && !includeDt) continue;
+        if (a->values[f] != b->values[f]) return false;
+    }
+    return true;
+}
+
+// --- Вывод отличающихся полей тика ---
+static void PrintFrameDiff(uint32_t tick, const TraceFrame *a, const TraceFrame *b, bool includeDt)
+{
+    printf("first divergence at tick %u\n", tick);
+    printf("  %-16s %14s %14s\n", "field", "a", "b");
+    for (int f = 0; f < TRACE_FIELD_COUNT; f++) {
+        if (a->values[f] == b->values[f] || (f == TRACE_DT_US && !includeDt)) continue;
+        if (f == TRACE_FLAGS) printf("  %-16s %#14x %#14x\n", TraceFieldName(f), (unsigned)a->values[f], (unsigned)b->values[f]);
+        else printf("  %-16s %14.4f %14.4f\n", TraceFieldName(f), TraceDequantize(f, a->values[f]), TraceDequantize(f, b->values[f]));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool includeDt = true;
+    const char *paths[2] = { NULL, NULL };
+    int pathCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ignore-dt") == 0) includeDt = false;
+        else if (pathCount < 2) paths[pathCount++] = argv[i];
+    }
+    if (pathCount < 2) {
+        fprintf(stderr, "Usage: trace_diff [--ignore-dt] <a.ptrc> <b.ptrc>\n"
+                        "Only meaningful for fixed-step runs or replays of recorded input: live runs have\n"
+                        "different frame times, so their positions drift apart anyway.\n");
+        return 2;
+    }
+
+    static TraceReader a, b;
+    if (!OpenTraceReader(&a, paths[0])) { fprintf(stderr, "Cannot open trace: %s\n", paths[0]); return 2; }
+    if (!OpenTraceReader(&b, paths[1])) { fprintf(stderr, "Cannot open trace: %s\n", paths[1]); CloseTraceReader(&a); return 2; }
+
+    // Свои буферы для сырых байт: payload читателя хранит загруженный для декодирования блок
+    int chunkCount = (a.chunkCount < b.chunkCount) ? a.chunkCount : b.chunkCount;
+    uint32_t maxPayload = 1;
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        if (a.chunks[chunk].payloadBytes > maxPayload) maxPayload = a.chunks[chunk].payloadBytes;
+        if (b.chunks[chunk].payloadBytes > maxPayload) maxPayload = b.chunks[chunk].payloadBytes;
+    }
+    unsigned char *rawA = (unsigned char *)malloc(maxPayload);
+    unsigned char *rawB = (unsigned char *)malloc(maxPayload);
+
+    int result = 0;
+    bool dtDiffers = false; // С --ignore-dt: dt уже разошёлся
+    uint32_t dtTick = 0;    // Первый тик с разным dt
+    for (int chunk = 0; chunk < chunkCount && result == 0; chunk++) {
+        const TraceChunkInfo *ca = &a.chunks[chunk], *cb = &b.chunks[chunk];
+
+        // Одинаковые байты - одинаковые тики, декодировать не нужно
+        if (ca->tickCount == cb->tickCount && ca->payloadBytes == cb->payloadBytes) {
+            if (!TraceReadChunkPayload(&a, chunk, rawA) || !TraceReadChunkPayload(&b, chunk, rawB)) {
+                fprintf(stderr, "Read error in chunk %d\n", chunk);
+                result = 2;
+                break;
+            }
+            if (memcmp(rawA, rawB, ca->payloadBytes) == 0) continue;
+        }
+
+        // Иначе сравниваем общую часть блока по тикам
+        uint32_t tick = ca->startTick;
+        uint32_t end = tick + (uint32_t)((ca->tickCount < cb->tickCount) ? ca->tickCount : cb->tickCount);
+        if (!TraceSeek(&a, tick) || !TraceSeek(&b, tick)) { fprintf(stderr, "Seek error at tick %u\n", tick); result = 2; break; }
+        for (; tick < end; tick++) {
+            TraceFrame fa, fb;
+            if (!TraceReadFrame(&a, &fa) || !TraceReadFrame(&b, &fb)) { fprintf(stderr, "Read error at tick %u\n", tick); result = 2; break; }
+            if (!dtDiffers && fa.values[TRACE_DT_US] != fb.values[TRACE_DT_US]) {
+                dtDiffers = true;
+                dtTick = tick;
+            }
+            if (!FramesEqual(&fa, &fb, includeDt)) {
+                PrintFrameDiff(tick, &fa, &fb, includeDt);
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    // Одна трасса - начало другой
+    if (result == 0 && a.tickCount != b.tickCount) {
+        uint32_t common = (a.tickCount < b.tickCount) ? a.tickCount : b.tickCount;
+        printf("traces match for %u ticks; %s has %u more\n", common, (a.tickCount > b.tickCount) ? "a" : "b",
+               (a.tickCount > b.tickCount) ? a.tickCount - common : b.tickCount - common);
+        result = 1;
+    }
+    if (result == 0) printf("traces identical (%u ticks%s)\n", a.tickCount, includeDt ? "" : ", dt ignored");
+    if (dtDiffers && !includeDt) printf("note: dt first differs at tick %u; positions integrate dt, so drift after it is expected\n", dtTick);
+
+    free(rawA);
+    free(rawB);
+    CloseTraceReader(&a);
+    CloseTraceReader(&b);
+    return result;
+}